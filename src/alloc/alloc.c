@@ -0,0 +1,348 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <stdalign.h>
+#include <stddef.h>
+
+#include "alloc.h"
+
+/**
+ * One block of an arena; blocks are chained newest first
+ */
+struct ArenaBlock {
+    ArenaBlock *next;
+    size_t used;
+    size_t size;
+    alignas(max_align_t) char data[];
+};
+
+/**
+ * Take size bytes aligned to align (a power of two) from the arena
+ * Returns pointer or NULL on allocation failure
+ */
+static void* arena_take(Arena *arena, size_t size, size_t align) {
+    ArenaBlock *block = arena->head;
+
+    if (block != NULL) {
+        size_t offset = (block->used + align - 1) & ~(align - 1);
+        if (offset <= block->size && size <= block->size - offset) {
+            block->used = offset + size;
+            return block->data + offset;
+        }
+    }
+
+    if (arena->block_size == 0) {
+        arena->block_size = ARENA_BLOCK_MIN;
+    }
+
+    // Requests larger than a regular block get a block of their own, linked
+    // behind the current one so its free space stays in use
+    size_t block_size = arena->block_size;
+    int own_block = size > block_size;
+    if (own_block) {
+        block_size = size;
+    }
+    if (block_size > SIZE_MAX - sizeof(ArenaBlock)) {
+        return NULL;
+    }
+
+    ArenaBlock *fresh = malloc(sizeof(ArenaBlock) + block_size);
+    if (fresh == NULL) {
+        return NULL;
+    }
+    fresh->size = block_size;
+    fresh->used = size;
+
+    if (own_block && block != NULL) {
+        fresh->next = block->next;
+        block->next = fresh;
+    } else {
+        fresh->next = block;
+        arena->head = fresh;
+        if (arena->block_size < ARENA_BLOCK_MAX) {
+            arena->block_size *= 2;
+        }
+    }
+    return fresh->data;
+}
+
+/**
+ * Allocate size bytes aligned for any type
+ * Returns pointer or NULL on allocation failure
+ */
+void* arena_alloc(Arena *arena, size_t size) {
+    return arena_take(arena, size, alignof(max_align_t));
+}
+
+/**
+ * Copy len bytes of s into the arena as a NUL-terminated string
+ * Returns the copy or NULL on allocation failure
+ */
+char* arena_strndup(Arena *arena, const char *s, size_t len) {
+    if (len == SIZE_MAX) {
+        return NULL;
+    }
+
+    char *copy = arena_take(arena, len + 1, 1);
+    if (copy == NULL) {
+        return NULL;
+    }
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+/**
+ * Copy a NUL-terminated string into the arena
+ * Returns the copy or NULL on allocation failure
+ */
+char* arena_strdup(Arena *arena, const char *s) {
+    return arena_strndup(arena, s, strlen(s));
+}
+
+/**
+ * Read the rest of a stream into one allocation of the arena
+ * The stream is read into a block of its own that doubles as it fills,
+ * so the data is copied O(1) times per byte and never split
+ * Returns the data or NULL on read or allocation failure
+ */
+char* arena_read_stream(Arena *arena, FILE *in, size_t *len) {
+    size_t cap = ARENA_BLOCK_MAX;
+    size_t used = 0;
+    ArenaBlock *block = malloc(sizeof(ArenaBlock) + cap);
+
+    while (block != NULL) {
+        used += fread(block->data + used, 1, cap - used, in);
+        if (used < cap) {
+            break;  // End of stream or error
+        }
+        if (cap > (SIZE_MAX - sizeof(ArenaBlock)) / 2) {
+            free(block);
+            return NULL;
+        }
+        cap *= 2;
+        ArenaBlock *grown = realloc(block, sizeof(ArenaBlock) + cap);
+        if (grown == NULL) {
+            free(block);
+            return NULL;
+        }
+        block = grown;
+    }
+    if (block == NULL) {
+        return NULL;
+    }
+    if (ferror(in)) {
+        free(block);
+        return NULL;
+    }
+
+    // used < cap here, so the terminator fits
+    block->data[used] = '\0';
+    block->size = cap;
+    block->used = cap;  // Nothing else is allocated from this block
+
+    // Link it behind the current block, as for other oversized requests
+    if (arena->head != NULL) {
+        block->next = arena->head->next;
+        arena->head->next = block;
+    } else {
+        block->next = NULL;
+        arena->head = block;
+    }
+
+    *len = used;
+    return block->data;
+}
+
+/**
+ * Free every allocation of the arena and leave it empty
+ */
+void arena_release(Arena *arena) {
+    ArenaBlock *block = arena->head;
+
+    while (block != NULL) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+    arena->block_size = 0;
+}
+
+/**
+ * Free every allocation of the arena but keep its current block for reuse
+ */
+void arena_reset(Arena *arena) {
+    ArenaBlock *head = arena->head;
+
+    if (head == NULL) {
+        return;
+    }
+
+    ArenaBlock *block = head->next;
+    while (block != NULL) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    head->next = NULL;
+    head->used = 0;
+}
+
+/**
+ * Move every allocation of other into arena, leaving other empty
+ */
+void arena_adopt(Arena *arena, Arena *other) {
+    ArenaBlock *first = other->head;
+
+    if (first == NULL) {
+        return;
+    }
+    if (arena->head == NULL) {
+        *arena = *other;
+    } else {
+        // Keep allocating from arena's current block
+        ArenaBlock *last = first;
+        while (last->next != NULL) {
+            last = last->next;
+        }
+        last->next = arena->head->next;
+        arena->head->next = first;
+    }
+    other->head = NULL;
+    other->block_size = 0;
+}
+
+/**
+ * Ensure a vector of item_size items has room for count items
+ * Returns 0 on success, 1 on allocation failure (*items is left intact)
+ */
+int vector_reserve(void **items, int *cap, int count, size_t item_size) {
+    if (count <= *cap) {
+        return 0;
+    }
+
+    size_t new_cap = *cap > 0 ? (size_t)*cap * 2 : 16;
+    if (new_cap < (size_t)count) {
+        new_cap = (size_t)count;
+    }
+    // Capacity is an int, and the array size must fit in size_t
+    size_t max_cap = SIZE_MAX / item_size < INT_MAX ? SIZE_MAX / item_size : INT_MAX;
+    if (new_cap > max_cap) {
+        new_cap = max_cap;
+        if (new_cap < (size_t)count) {
+            return 1;
+        }
+    }
+
+    void *tmp = realloc(*items, new_cap * item_size);
+    if (tmp == NULL) {
+        return 1;
+    }
+    *items = tmp;
+    *cap = (int)new_cap;
+    return 0;
+}
+
+/**
+ * 32-bit FNV-1a hash of a string
+ */
+static uint32_t hash_string(const char *s) {
+    uint32_t hash = 0x811c9dc5u;
+    for (; *s != '\0'; s++) {
+        hash ^= (unsigned char)*s;
+        hash *= 0x01000193u;
+    }
+    return hash;
+}
+
+/**
+ * Find the slot holding s, or the free slot where it would go
+ * table->size must be non-zero
+ */
+static size_t intern_slot(const StringTable *table, const char *s) {
+    size_t mask = table->size - 1;
+    size_t slot = hash_string(s) & mask;
+
+    while (table->slots[slot] != 0 &&
+           strcmp(table->strings[table->slots[slot] - 1], s) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * Double the hash (or create it), keeping it at most half full
+ * Returns 0 on success, 1 on allocation failure
+ */
+static int intern_grow(StringTable *table) {
+    size_t size = table->size != 0 ? table->size * 2 : 16;
+    int *slots = calloc(size, sizeof(int));
+    if (slots == NULL) {
+        return 1;
+    }
+
+    free(table->slots);
+    table->slots = slots;
+    table->size = size;
+    for (int id = 0; id < table->count; id++) {
+        table->slots[intern_slot(table, table->strings[id])] = id + 1;
+    }
+    return 0;
+}
+
+/**
+ * Intern a NUL-terminated string
+ * Returns its id or -1 on allocation failure
+ */
+int intern(StringTable *table, const char *s) {
+    if ((size_t)table->count + 1 > table->size / 2 && intern_grow(table) != 0) {
+        return -1;
+    }
+
+    size_t slot = intern_slot(table, s);
+    if (table->slots[slot] != 0) {
+        return table->slots[slot] - 1;
+    }
+
+    if (table->count == INT_MAX - 1 ||
+        vector_reserve((void**)&table->strings, &table->cap, table->count + 1,
+                       sizeof(char*)) != 0) {
+        return -1;
+    }
+    char *copy = arena_strdup(&table->arena, s);
+    if (copy == NULL) {
+        return -1;
+    }
+
+    int id = table->count++;
+    table->strings[id] = copy;
+    table->slots[slot] = id + 1;
+    return id;
+}
+
+/**
+ * Look up a string without adding it
+ * Returns its id, or -1 if it was never interned
+ */
+int intern_find(const StringTable *table, const char *s) {
+    if (table->size == 0) {
+        return -1;
+    }
+    return table->slots[intern_slot(table, s)] - 1;
+}
+
+/**
+ * Free every string of the table and leave it empty
+ */
+void intern_release(StringTable *table) {
+    free(table->strings);
+    free(table->slots);
+    arena_release(&table->arena);
+    table->strings = NULL;
+    table->count = 0;
+    table->cap = 0;
+    table->slots = NULL;
+    table->size = 0;
+}
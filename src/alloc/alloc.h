@@ -0,0 +1,126 @@
+#ifndef ALLOC_ALLOC_H
+#define ALLOC_ALLOC_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+// First block size of an arena; each new block doubles, up to ARENA_BLOCK_MAX
+#define ARENA_BLOCK_MIN 1024
+#define ARENA_BLOCK_MAX (1024 * 1024)
+
+typedef struct ArenaBlock ArenaBlock;
+
+/**
+ * Bump allocator for data that is freed all at once
+ * Allocations are carved from a chain of blocks; there is no per-allocation
+ * free, arena_release() frees every block. A zeroed Arena is empty and
+ * allocates nothing until first used.
+ *
+ * Fields:
+ *   head       - Block allocations are currently taken from
+ *   block_size - Size of the next block
+ */
+typedef struct {
+    ArenaBlock *head;
+    size_t block_size;
+} Arena;
+
+/**
+ * Allocate size bytes aligned for any type
+ * Returns pointer or NULL on allocation failure
+ */
+void* arena_alloc(Arena *arena, size_t size);
+
+/**
+ * Copy len bytes of s into the arena as a NUL-terminated string
+ * Returns the copy or NULL on allocation failure
+ */
+char* arena_strndup(Arena *arena, const char *s, size_t len);
+
+/**
+ * Copy a NUL-terminated string into the arena
+ * Returns the copy or NULL on allocation failure
+ */
+char* arena_strdup(Arena *arena, const char *s);
+
+/**
+ * Read the rest of a stream into one allocation of the arena
+ * The data is followed by a NUL byte (not counted in *len), so a parser
+ * may terminate its last token in place
+ * Returns the data or NULL on read or allocation failure
+ */
+char* arena_read_stream(Arena *arena, FILE *in, size_t *len);
+
+/**
+ * Free every allocation of the arena and leave it empty
+ */
+void arena_release(Arena *arena);
+
+/**
+ * Free every allocation of the arena but keep its current block for reuse
+ * For per-record scratch strings: a loop that resets the arena after each
+ * record allocates only when a record outgrows the block
+ */
+void arena_reset(Arena *arena);
+
+/**
+ * Move every allocation of other into arena, leaving other empty
+ * Pointers into other stay valid and are freed with arena; used to collect
+ * the arenas that worker threads filled into the list that owns the data
+ */
+void arena_adopt(Arena *arena, Arena *other);
+
+/**
+ * Ensure a vector of item_size items has room for count items
+ * *items is reallocated to at least double its capacity *cap, so appending
+ * one item at a time copies each item O(1) times on average
+ * Returns 0 on success, 1 on allocation failure (*items is left intact)
+ *
+ * Example usage:
+ *   if (vector_reserve((void**)&list->items, &list->cap, list->count + 1,
+ *                      sizeof(Node)) != 0) return 1;
+ *   list->items[list->count++] = node;
+ */
+int vector_reserve(void **items, int *cap, int count, size_t item_size);
+
+/**
+ * Table of interned strings: each distinct string is stored once and
+ * named by a small integer id, so equal strings compare as equal ids.
+ * A zeroed StringTable is empty.
+ *
+ * Fields:
+ *   strings - Interned strings by id (in arena)
+ *   count   - Number of strings
+ *   cap     - Allocated length of strings
+ *   slots   - Open-addressing hash of the strings: id + 1, or 0 if free
+ *   size    - Number of slots (a power of two, or 0 before first use)
+ *   arena   - Holds the string bytes
+ */
+typedef struct {
+    char **strings;
+    int count;
+    int cap;
+    int *slots;
+    size_t size;
+    Arena arena;
+} StringTable;
+
+/**
+ * Intern a NUL-terminated string
+ * Returns its id (>= 0; the same id for every equal string) or -1 on
+ * allocation failure; the string itself is table->strings[id]
+ */
+int intern(StringTable *table, const char *s);
+
+/**
+ * Look up a string without adding it
+ * Returns its id, or -1 if it was never interned
+ */
+int intern_find(const StringTable *table, const char *s);
+
+/**
+ * Free every string of the table and leave it empty
+ */
+void intern_release(StringTable *table);
+
+#endif /* ALLOC_ALLOC_H */
@@ -0,0 +1,10 @@
+#include <stdio.h>
+#include "build.h"
+
+/**
+ * Standalone executable for debugging the build function
+ * Build with: make (from this directory)
+ */
+int main(int argc, char **argv) {
+    return build(argc, argv);
+}
@@ -0,0 +1,275 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#include "build.h"
+#include "alloc/alloc.h"
+#include "nodes/nodes.h"
+#include "edges/edges.h"
+#include "find/walk.h"
+#include "frontmatter/frontmatter.h"
+#include "frontmatter/reader.h"
+
+#define DEFAULT_PATTERN "\\.md$"
+
+/**
+ * Paths found by the walk and the notes parsed from them
+ * Edges point into nodes.items, so they are resolved once every note is read
+ *
+ * Fields:
+ *   paths      - Matching files in walk order (in nodes.arena)
+ *   path_count - Number of paths
+ *   path_cap   - Allocated length of paths
+ *   nodes      - Valid notes, in walk order
+ *   links      - Links of nodes.items[i] (owned)
+ *   cap        - Allocated length of links
+ *   failed     - An allocation failed
+ */
+typedef struct {
+    char **paths;
+    int path_count;
+    int path_cap;
+    NodeList nodes;
+    LinkList **links;
+    int cap;
+    int failed;
+} BuildState;
+
+/**
+ * Display help message
+ */
+static void help(void) {
+    printf("Usage: jig build [OPTIONS] [DIRECTORY]\n");
+    printf("       jig-build [OPTIONS] [DIRECTORY]\n");
+    printf("\n");
+    printf("Build node and edge lists of a note tree in one pass.\n");
+    printf("\n");
+    printf("Same output as jig find | jig filter | jig nodes | jig edges, but each note\n");
+    printf("is read once and edges are resolved in memory.\n");
+    printf("\n");
+    printf("Options:\n");
+    printf("  -h, --help            Display this help and exit\n");
+    printf("  -p, --pattern REGEX   Filename pattern of notes (repeatable, default: %s)\n",
+           DEFAULT_PATTERN);
+    printf("  -o, --output DIR      Write nodes.csv and edges.csv to DIR (default: .)\n");
+    printf("\n");
+    printf("Examples:\n");
+    printf("  jig build                      Notes under the current directory\n");
+    printf("  jig build -o data content      Write data/nodes.csv and data/edges.csv\n");
+    printf("  jig build -p '\\.en\\.md$' .     English notes only\n");
+}
+
+/**
+ * Check the note criteria of jig filter: frontmatter with an id of
+ * 1-36 bytes and a non-empty title (first occurrence of each)
+ */
+static int is_valid_note(int has_frontmatter, const FrontmatterFields *fields) {
+    return has_frontmatter &&
+           fields->id != NULL && fields->id_len > 0 && fields->id_len <= 36 &&
+           fields->title != NULL && fields->title_len > 0;
+}
+
+/**
+ * Collect one path found by the walk
+ * Paths are gathered before any note is read, so the strings that link
+ * resolution scans for every link sit together in memory
+ */
+static void collect_path(const char *path, void *arg) {
+    BuildState *state = arg;
+
+    if (vector_reserve((void**)&state->paths, &state->path_cap, state->path_count + 1,
+                       sizeof(char*)) != 0) {
+        state->failed = 1;
+        return;
+    }
+
+    state->paths[state->path_count] = arena_strdup(&state->nodes.arena, path);
+    if (state->paths[state->path_count] == NULL) {
+        state->failed = 1;
+        return;
+    }
+    state->path_count++;
+}
+
+/**
+ * Append a node and its links to the state
+ * Returns 0 on success, 1 on allocation failure
+ */
+static int add_note(BuildState *state, char *path, const FrontmatterFields *fields,
+                    LinkList *links) {
+    int count = state->nodes.count;
+    if (vector_reserve((void**)&state->nodes.items, &state->nodes.cap, count + 1,
+                       sizeof(Node)) != 0 ||
+        vector_reserve((void**)&state->links, &state->cap, count + 1,
+                       sizeof(LinkList*)) != 0) {
+        return 1;
+    }
+
+    Node *node = &state->nodes.items[count];
+    node->title = arena_strndup(&state->nodes.arena, fields->title, fields->title_len);
+    if (node->title == NULL) {
+        return 1;
+    }
+    node->path = path;
+    node->values = NULL;
+    memcpy(node->id, fields->id, fields->id_len);
+    node->id[fields->id_len] = '\0';
+
+    state->links[state->nodes.count] = links;
+    state->nodes.count++;
+    return 0;
+}
+
+/**
+ * Read one note: validate it and extract its fields and links from
+ * a single view of the file
+ */
+static void read_note(BuildState *state, char *path) {
+    FileView view;
+    FrontmatterFields fields;
+
+    if (file_view_open(&view, path) != 0) {
+        return;  // Unreadable files are skipped, as by jig filter
+    }
+
+    int has_frontmatter = frontmatter_fields(view.data, view.len, &fields) == 0;
+    if (is_valid_note(has_frontmatter, &fields)) {
+        LinkList *links = extract_links_from_content(view.data, view.len);
+        if (links == NULL || add_note(state, path, &fields, links) != 0) {
+            fprintf(stderr, "Failed to allocate memory for note: %s\n", path);
+            free_links(links);
+            state->failed = 1;
+        }
+    }
+
+    file_view_close(&view);
+}
+
+/**
+ * Write a list to dir/name with the given printer
+ * Returns 0 on success, 1 on error
+ */
+static int write_csv(const char *dir, const char *name, void (*print)(FILE*, void*), void *list) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+    FILE *out = fopen(path, "w");
+    if (out == NULL) {
+        fprintf(stderr, "Error: Cannot write %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    print(out, list);
+    if (fclose(out) != 0) {
+        fprintf(stderr, "Error: Cannot write %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    return 0;
+}
+
+static void print_nodes(FILE *out, void *list) {
+    print_nodes_csv(out, list);
+}
+
+static void print_edges(FILE *out, void *list) {
+    print_edges_csv(out, list);
+}
+
+/**
+ * Entry point for build command
+ */
+int build(int argc, char **argv) {
+    const char *root = ".";
+    const char *output = ".";
+    const char *patterns[argc + 1];
+    int pattern_count = 0;
+    Matcher matcher;
+    BuildState state = {0};
+    EdgeList edges = {0};
+    int status = 0;
+
+    // Parse arguments
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            help();
+            return 0;
+        } else if (strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--pattern") == 0) {
+            // Next argument should be the pattern
+            if (i + 1 < argc) {
+                patterns[pattern_count++] = argv[i + 1];
+                i++; // Skip next argument
+            } else {
+                fprintf(stderr, "Error: -p/--pattern requires a pattern argument\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) {
+            // Next argument should be the output directory
+            if (i + 1 < argc) {
+                output = argv[i + 1];
+                i++; // Skip next argument
+            } else {
+                fprintf(stderr, "Error: -o/--output requires a directory argument\n");
+                return 1;
+            }
+        } else if (argv[i][0] != '-') {
+            // Non-option argument is the directory
+            root = argv[i];
+        } else {
+            fprintf(stderr, "Error: Unknown option: %s\n", argv[i]);
+            help();
+            return 1;
+        }
+    }
+
+    if (pattern_count == 0) {
+        patterns[pattern_count++] = DEFAULT_PATTERN;
+    }
+    if (compile_matcher(patterns, pattern_count, &matcher) != 0) {
+        return 1;
+    }
+
+    if (walk_files(root, &matcher, collect_path, &state) != 0) {
+        status = 1;
+    }
+    free_matcher(&matcher);
+
+    // Validate and parse: one read per note
+    for (int i = 0; i < state.path_count && !state.failed; i++) {
+        read_note(&state, state.paths[i]);
+    }
+    free(state.paths);
+
+    // Resolve links against the complete node list
+    if (!state.failed && index_nodes(&state.nodes) != 0) {
+        fprintf(stderr, "Failed to allocate memory for node indexes\n");
+        state.failed = 1;
+    }
+    for (int i = 0; i < state.nodes.count && !state.failed; i++) {
+        if (add_link_edges(&edges, &state.nodes, &state.nodes.items[i], state.links[i]) != 0) {
+            fprintf(stderr, "Failed to allocate memory for edges\n");
+            state.failed = 1;
+        }
+    }
+
+    if (state.failed) {
+        status = 1;
+    } else if (write_csv(output, "nodes.csv", print_nodes, &state.nodes) != 0 ||
+               write_csv(output, "edges.csv", print_edges, &edges) != 0) {
+        status = 1;
+    }
+
+    // Cleanup
+    free(edges.items);
+    intern_release(&edges.labels);
+    for (int i = 0; i < state.nodes.count; i++) {
+        free_links(state.links[i]);
+    }
+    free(state.links);
+    free_node_indexes(&state.nodes);
+    free(state.nodes.items);
+    arena_release(&state.nodes.arena);
+
+    return status;
+}
@@ -0,0 +1,16 @@
+#ifndef BUILD_H
+#define BUILD_H
+
+/**
+ * Build the node and edge lists of a note tree in one process
+ * Usage:
+ *   jig build [OPTIONS] [DIRECTORY]
+ *
+ * Equivalent to find | filter | nodes | edges, but each note is read once
+ * and edges are resolved in memory; writes nodes.csv and edges.csv
+ *
+ * Returns 0 on success, non-zero on error
+ */
+int build(int argc, char **argv);
+
+#endif /* BUILD_H */
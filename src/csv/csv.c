@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "csv.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CSV_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+/**
+ * Check for a byte that ends an unquoted field or starts a quoted one
+ */
+static int is_special(char c) {
+    return c == ',' || c == '"' || c == '\n' || c == '\r';
+}
+
+/**
+ * Find the next special byte one byte at a time
+ * Returns its position, or end if there is none
+ */
+static const char* scan_scalar(const char *p, const char *end) {
+    while (p < end && !is_special(*p)) {
+        p++;
+    }
+    return p;
+}
+
+#ifdef CSV_X86_SIMD
+/**
+ * Find the next special byte 16 bytes at a time (SSE2, always present on x86-64)
+ * Returns its position, or end if there is none
+ */
+static const char* scan_sse2(const char *p, const char *end) {
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, comma), _mm_cmpeq_epi8(v, quote)),
+                                   _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+        int mask = _mm_movemask_epi8(hit);
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+    return scan_scalar(p, end);
+}
+
+/**
+ * Find the next special byte 32 bytes at a time (AVX2, checked at run time)
+ * Returns its position, or end if there is none
+ */
+__attribute__((target("avx2")))
+static const char* scan_avx2(const char *p, const char *end) {
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        __m256i hit = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, comma), _mm256_cmpeq_epi8(v, quote)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr)));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(hit);
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+    return scan_sse2(p, end);
+}
+#endif
+
+/**
+ * Start reading len bytes of data (data[len] must be writable)
+ */
+void csv_reader_init(CsvReader *reader, char *data, size_t len) {
+    reader->pos = data;
+    reader->end = data + len;
+#ifdef CSV_X86_SIMD
+    reader->scan = __builtin_cpu_supports("avx2") ? scan_avx2 : scan_sse2;
+#else
+    reader->scan = scan_scalar;
+#endif
+}
+
+/**
+ * Find the end of a field's unquoted text: the next comma, CR or LF
+ * A quote inside unquoted text is kept as an ordinary character
+ */
+static char* field_end(const CsvReader *reader, char *p) {
+    for (;;) {
+        p = (char*)reader->scan(p, reader->end);
+        if (p < reader->end && *p == '"') {
+            p++;
+            continue;
+        }
+        return p;
+    }
+}
+
+/**
+ * Read the next row into fields
+ * Returns the number of fields in the row, or -1 at end of input
+ */
+int csv_read_row(CsvReader *reader, char **fields, int max_fields) {
+    char *p = reader->pos;
+    char *end = reader->end;
+    int count = 0;
+
+    if (p >= end) {
+        return -1;
+    }
+
+    for (;;) {
+        char *value = p;
+        char *value_end;
+        char *delim;
+
+        if (p < end && *p == '"') {
+            // Quoted field: copy it down over its opening quote, undoubling quotes
+            char *out = p;
+            p++;
+            for (;;) {
+                char *quote = memchr(p, '"', end - p);
+                if (quote == NULL) {
+                    quote = end;  // Unterminated: the field runs to the end of input
+                }
+                memmove(out, p, quote - p);
+                out += quote - p;
+                p = quote;
+                if (p == end) {
+                    break;
+                }
+                p++;
+                if (p < end && *p == '"') {
+                    *out++ = '"';
+                    p++;
+                    continue;
+                }
+                break;
+            }
+
+            // Text between the closing quote and the delimiter is kept
+            delim = field_end(reader, p);
+            memmove(out, p, delim - p);
+            value_end = out + (delim - p);
+        } else {
+            delim = field_end(reader, p);
+            value_end = delim;
+        }
+
+        char c = delim < end ? *delim : '\n';
+        *value_end = '\0';  // May overwrite the delimiter, already saved in c
+        if (count < max_fields) {
+            fields[count] = value;
+        }
+        count++;
+
+        if (c == ',') {
+            p = delim + 1;
+            continue;
+        }
+
+        // End of row: LF, CRLF, CR or end of input
+        p = delim < end ? delim + 1 : end;
+        if (c == '\r' && p < end && *p == '\n') {
+            p++;
+        }
+        reader->pos = p;
+        return count;
+    }
+}
+
+/**
+ * Write one field, quoted only if it contains a comma, quote, CR or LF
+ */
+void csv_write_field(FILE *out, const char *value) {
+    if (value == NULL) {
+        return;
+    }
+    if (value[strcspn(value, ",\"\r\n")] == '\0') {
+        fputs(value, out);
+        return;
+    }
+
+    putc('"', out);
+    for (const char *p = value; *p != '\0'; p++) {
+        if (*p == '"') {
+            putc('"', out);
+        }
+        putc(*p, out);
+    }
+    putc('"', out);
+}
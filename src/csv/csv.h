@@ -0,0 +1,46 @@
+#ifndef CSV_CSV_H
+#define CSV_CSV_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/**
+ * RFC 4180 reader over a writable in-memory buffer
+ * Fields are returned as slices of the buffer: delimiters are overwritten
+ * with NUL and quoted fields are unescaped in place, so reading a row
+ * copies nothing. The buffer must be followed by one writable byte
+ * (arena_read_stream() provides it).
+ *
+ * Fields:
+ *   pos  - Start of the next row
+ *   end  - End of the data
+ *   scan - Finds the next comma, quote, CR or LF; the widest SIMD
+ *          version the CPU supports (AVX2, SSE2) or a scalar loop
+ */
+typedef struct {
+    char *pos;
+    char *end;
+    const char *(*scan)(const char *p, const char *end);
+} CsvReader;
+
+/**
+ * Start reading len bytes of data (data[len] must be writable)
+ */
+void csv_reader_init(CsvReader *reader, char *data, size_t len);
+
+/**
+ * Read the next row into fields (at most max_fields; extra fields are
+ * consumed and dropped). Rows end at LF, CRLF or CR outside quotes;
+ * quoted fields may contain delimiters, newlines and "" for a quote.
+ * A blank line is a row with one empty field.
+ * Returns the number of fields in the row, or -1 at end of input
+ */
+int csv_read_row(CsvReader *reader, char **fields, int max_fields);
+
+/**
+ * Write one field, quoted only if it contains a comma, quote, CR or LF
+ * (quotes are doubled); NULL is written as an empty field
+ */
+void csv_write_field(FILE *out, const char *value);
+
+#endif /* CSV_CSV_H */
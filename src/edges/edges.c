@@ -5,6 +5,10 @@
 #include <regex.h>
 
 #include "edges.h"
+#include "frontmatter/cache.h"
+#include "frontmatter/reader.h"
+#include "graph/graph.h"
+#include "csv/csv.h"
 
 /**
  * Display help message
@@ -15,13 +19,18 @@ static void help(void) {
     printf("\n");
     printf("Extract and list edges (relationships) between nodes.\n");
     printf("\n");
-    printf("Reads node CSV from stdin and outputs edge information as CSV.\n");
+    printf("Reads node CSV (or a jig nodes --format bin stream) from stdin and\n");
+    printf("outputs edge information as CSV.\n");
     printf("\n");
     printf("Options:\n");
     printf("  -h, --help          Display this help and exit\n");
+    printf("      --cache         Reuse links parsed by earlier runs (%s)\n",
+           FRONTMATTER_CACHE_FILE);
+    printf("      --format FMT    Output format: csv (default) or bin\n");
     printf("\n");
     printf("Output Format:\n");
     printf("  CSV with columns: src_id,src_title,dst_id,dst_title,label,src_path,dst_path\n");
+    printf("  bin: binary stream of nodes and edges read by jig tree and jig hierarchy\n");
     printf("\n");
     printf("Examples:\n");
     printf("  jig find . -p \"\\.md$\" | jig filter | jig nodes | jig edges\n");
@@ -29,44 +38,36 @@ static void help(void) {
 }
 
 /**
- * Extract label from query parameter in URL
+ * Extract label from query parameter in URL into arena
  * Input: "/path/file.md?label=parent&other=value"
- * Output: "parent" (allocated string)
- * Returns NULL if no label parameter found
+ * Output: "parent"; "link" if no label parameter found
+ * Returns the label or NULL on allocation failure
  */
-static char* extract_label_from_url(const char *url) {
+static char* extract_label_from_url(Arena *arena, const char *url) {
     // Find start of query string
     char *query_start = strchr(url, '?');
-    if (query_start == NULL) return NULL;
+    if (query_start == NULL) return arena_strdup(arena, "link");
 
     // Find label parameter
     char *label_param = strstr(query_start, "label=");
-    if (label_param == NULL) return NULL;
+    if (label_param == NULL) return arena_strdup(arena, "link");
 
     // Move past "label="
     char *label_start = label_param + 6;
 
     // Find end of label value (& or end of string)
-    char *label_end = strchr(label_start, '&');
-    size_t label_len = label_end ? (size_t)(label_end - label_start) : strlen(label_start);
+    size_t label_len = strcspn(label_start, "&");
+    if (label_len == 0) return arena_strdup(arena, "link");
 
-    if (label_len == 0) return NULL;
-
-    // Allocate and copy
-    char *label = malloc(label_len + 1);
-    if (label == NULL) return NULL;
-    strncpy(label, label_start, label_len);
-    label[label_len] = '\0';
-
-    return label;
+    return arena_strndup(arena, label_start, label_len);
 }
 
 /**
- * Extract all markdown links from content
+ * Extract all markdown links from len bytes of content (not NUL-terminated)
  * Pattern: [text](url) or [text](url?label=X)
  * Returns LinkList* or NULL on error
  */
-static LinkList* extract_links_from_content(const char *content) {
+LinkList* extract_links_from_content(const char *content, size_t len) {
     regex_t rgx;
     regmatch_t matches[3];
 
@@ -76,75 +77,36 @@ static LinkList* extract_links_from_content(const char *content) {
         return NULL;
     }
 
-    LinkList *list = malloc(sizeof(LinkList));
+    LinkList *list = calloc(1, sizeof(LinkList));
     if (list == NULL) {
         regfree(&rgx);
         return NULL;
     }
-    list->items = NULL;
-    list->count = 0;
 
-    // Find all matches
+    // Find all matches; REG_STARTEND bounds the search by matches[0]
     const char *cursor = content;
-    while (regexec(&rgx, cursor, 3, matches, 0) == 0) {
-        // Extract text (group 1)
-        int text_len = matches[1].rm_eo - matches[1].rm_so;
-        char *text = malloc(text_len + 1);
-        if (text == NULL) {
-            regfree(&rgx);
-            for (int i = 0; i < list->count; i++) {
-                free(list->items[i].text);
-                free(list->items[i].path);
-                free(list->items[i].label);
-            }
-            free(list->items);
-            free(list);
-            return NULL;
-        }
-        strncpy(text, cursor + matches[1].rm_so, text_len);
-        text[text_len] = '\0';
-
-        // Extract URL (group 2)
-        int url_len = matches[2].rm_eo - matches[2].rm_so;
-        char *url = malloc(url_len + 1);
-        if (url == NULL) {
-            free(text);
-            regfree(&rgx);
-            for (int i = 0; i < list->count; i++) {
-                free(list->items[i].text);
-                free(list->items[i].path);
-                free(list->items[i].label);
-            }
-            free(list->items);
-            free(list);
-            return NULL;
+    const char *end = content + len;
+    for (;;) {
+        matches[0].rm_so = 0;
+        matches[0].rm_eo = end - cursor;
+        if (regexec(&rgx, cursor, 3, matches, REG_STARTEND) != 0) {
+            break;
         }
-        strncpy(url, cursor + matches[2].rm_so, url_len);
-        url[url_len] = '\0';
 
-        // Extract label from URL or use default
-        char *label = extract_label_from_url(url);
-        if (label == NULL) {
-            label = strdup("link");
-        }
+        // Extract text (group 1), URL (group 2) and label from URL or default
+        char *text = arena_strndup(&list->arena, cursor + matches[1].rm_so,
+                                   matches[1].rm_eo - matches[1].rm_so);
+        char *url = arena_strndup(&list->arena, cursor + matches[2].rm_so,
+                                  matches[2].rm_eo - matches[2].rm_so);
+        char *label = url ? extract_label_from_url(&list->arena, url) : NULL;
 
-        // Add to list (realloc, store values)
-        Link *tmp = realloc(list->items, (list->count + 1) * sizeof(Link));
-        if (tmp == NULL) {
-            free(text);
-            free(url);
-            free(label);
+        // Add to list
+        if (text == NULL || label == NULL ||
+            vector_reserve((void**)&list->items, &list->cap, list->count + 1, sizeof(Link)) != 0) {
             regfree(&rgx);
-            for (int i = 0; i < list->count; i++) {
-                free(list->items[i].text);
-                free(list->items[i].path);
-                free(list->items[i].label);
-            }
-            free(list->items);
-            free(list);
+            free_links(list);
             return NULL;
         }
-        list->items = tmp;
 
         list->items[list->count].text = text;
         list->items[list->count].path = url;
@@ -160,134 +122,177 @@ static LinkList* extract_links_from_content(const char *content) {
 }
 
 /**
- * Extract all markdown links from a file
+ * Free link list memory
+ */
+void free_links(LinkList *list) {
+    if (list == NULL) return;
+    free(list->items);
+    arena_release(&list->arena);
+    free(list);
+}
+
+/**
+ * Build a link list from a cached note's links
+ * Returns LinkList* or NULL on error
  */
-static LinkList* extract_links_from_file(const char *filepath) {
-    FILE *fptr = fopen(filepath, "r");
-    if (fptr == NULL) return NULL;
-
-    // Read file size
-    fseek(fptr, 0L, SEEK_END);
-    long filesize = ftell(fptr);
-    fseek(fptr, 0L, SEEK_SET);
-
-    // Read content
-    char *content = malloc(filesize + 1);
-    if (content == NULL) {
-        fclose(fptr);
+static LinkList* links_from_cache(const CachedNote *note) {
+    LinkList *list = calloc(1, sizeof(LinkList));
+    if (list == NULL) return NULL;
+
+    if (vector_reserve((void**)&list->items, &list->cap, (int)note->link_count,
+                       sizeof(Link)) != 0) {
+        free(list);
         return NULL;
     }
 
-    fread(content, 1, filesize, fptr);
-    content[filesize] = '\0';
-    fclose(fptr);
+    for (uint32_t i = 0; i < note->link_count; i++) {
+        const char *url = note->strings + note->links[i].url;
+        Link *link = &list->items[i];
+
+        link->text = arena_strdup(&list->arena, note->strings + note->links[i].text);
+        link->path = arena_strdup(&list->arena, url);
+        link->label = extract_label_from_url(&list->arena, url);
+        list->count++;
+
+        if (link->text == NULL || link->path == NULL || link->label == NULL) {
+            free_links(list);
+            return NULL;
+        }
+    }
+
+    return list;
+}
+
+/**
+ * Remember the links extracted from a file in the cache
+ */
+static void store_links(FrontmatterCache *cache, const NoteKey *key, const LinkList *links) {
+    const char **texts = malloc((links->count ? links->count : 1) * sizeof(char*));
+    const char **urls = malloc((links->count ? links->count : 1) * sizeof(char*));
+
+    if (texts != NULL && urls != NULL) {
+        for (int i = 0; i < links->count; i++) {
+            texts[i] = links->items[i].text;
+            urls[i] = links->items[i].path;
+        }
+        frontmatter_cache_store_links(cache, key, links->count, texts, urls);
+    }
+    free(texts);
+    free(urls);
+}
+
+/**
+ * Extract all markdown links from a file
+ * With cache, links of unchanged files are not extracted again
+ */
+static LinkList* extract_links_from_file(const char *filepath, FrontmatterCache *cache) {
+    NoteKey key;
+    CachedNote note;
+
+    if (cache != NULL &&
+        frontmatter_cache_lookup(cache, filepath, &key, &note) == 0 &&
+        (note.flags & CACHED_LINKS)) {
+        return links_from_cache(&note);
+    }
+
+    FileView view;
+    if (file_view_open(&view, filepath) != 0) return NULL;
 
     // Extract links
-    LinkList *links = extract_links_from_content(content);
-    free(content);
+    LinkList *links = extract_links_from_content(view.data, view.len);
+    file_view_close(&view);
 
+    if (links != NULL && cache != NULL) {
+        store_links(cache, &key, links);
+    }
     return links;
 }
 
 /**
- * Free link list memory
+ * Add an edge from src to the node each link points to
+ * Links whose target is not among nodes are skipped
+ * Returns 0 on success, 1 on allocation failure
  */
-static void free_links(LinkList *list) {
-    if (list == NULL) return;
-    for (int i = 0; i < list->count; i++) {
-        free(list->items[i].text);
-        free(list->items[i].path);
-        free(list->items[i].label);
+int add_link_edges(EdgeList *edges, NodeList *nodes, Node *src, const LinkList *links) {
+    // For each link found
+    for (int j = 0; j < links->count; j++) {
+        Link *link = &links->items[j];
+
+        // Find target node by path, query string removed
+        Node *dst_node = find_node_by_path(nodes, link->path, strcspn(link->path, "?"));
+        if (dst_node == NULL) continue;  // Target not found
+
+        // Create edge
+        if (vector_reserve((void**)&edges->items, &edges->cap, edges->count + 1,
+                           sizeof(Edge)) != 0) {
+            return 1;
+        }
+
+        Edge *edge = &edges->items[edges->count];
+        edge->src = src;
+        edge->dst = dst_node;
+        edge->label = intern(&edges->labels, link->label);
+        if (edge->label < 0) {
+            return 1;
+        }
+
+        edges->count++;
     }
-    free(list->items);
-    free(list);
+
+    return 0;
 }
 
 /**
  * Build edges from nodes by extracting all links from files
+ * cache (--cache) may be NULL
  * Returns EdgeList* or NULL on error
  */
-EdgeList* build_edges_from_nodes(NodeList *nodes) {
-    EdgeList *edges = malloc(sizeof(EdgeList));
+EdgeList* build_edges_from_nodes(NodeList *nodes, FrontmatterCache *cache) {
+    EdgeList *edges = calloc(1, sizeof(EdgeList));
     if (edges == NULL) return NULL;
-    edges->items = NULL;
-    edges->count = 0;
+
+    if (index_nodes(nodes) != 0) {
+        free(edges);
+        return NULL;
+    }
 
     // For each source node
     for (int i = 0; i < nodes->count; i++) {
         Node *src_node = &nodes->items[i];
 
         // Extract all links from this file
-        LinkList *links = extract_links_from_file(src_node->path);
+        LinkList *links = extract_links_from_file(src_node->path, cache);
         if (links == NULL) continue;
 
-        // For each link found
-        for (int j = 0; j < links->count; j++) {
-            Link *link = &links->items[j];
-
-            // Strip query string from link path for matching
-            char *query_pos = strchr(link->path, '?');
-            char link_path_clean[1024];
-            if (query_pos != NULL) {
-                size_t path_len = query_pos - link->path;
-                strncpy(link_path_clean, link->path, path_len);
-                link_path_clean[path_len] = '\0';
-            } else {
-                strncpy(link_path_clean, link->path, sizeof(link_path_clean) - 1);
-                link_path_clean[sizeof(link_path_clean) - 1] = '\0';
-            }
-
-            // Find target node by matching path (using strstr)
-            Node *dst_node = NULL;
-            for (int k = 0; k < nodes->count; k++) {
-                if (strstr(nodes->items[k].path, link_path_clean) != NULL) {
-                    dst_node = &nodes->items[k];
-                    break;
-                }
-            }
-
-            if (dst_node == NULL) continue;  // Target not found
-
-            // Create edge
-            Edge *tmp = realloc(edges->items, (edges->count + 1) * sizeof(Edge));
-            if (tmp == NULL) {
-                free_links(links);
-                free_edges(edges);
-                return NULL;
-            }
-            edges->items = tmp;
-
-            Edge *edge = &edges->items[edges->count];
-            edge->src = src_node;
-            edge->dst = dst_node;
-            edge->label = strdup(link->label);  // Copy label from link
-
-            edges->count++;
-        }
-
+        int failed = add_link_edges(edges, nodes, src_node, links);
         free_links(links);
+        if (failed) {
+            free_edges(edges);
+            return NULL;
+        }
     }
 
     return edges;
 }
 
 /**
- * Print edges as CSV to stdout
+ * Print edges as CSV to out
  * Format: src_id,src_title,dst_id,dst_title,label,src_path,dst_path
  */
-void print_edges_csv(EdgeList *edges) {
-    printf("src_id,src_title,dst_id,dst_title,label,src_path,dst_path\n");
+void print_edges_csv(FILE *out, EdgeList *edges) {
+    fprintf(out, "src_id,src_title,dst_id,dst_title,label,src_path,dst_path\n");
     for (int i = 0; i < edges->count; i++) {
         Edge *edge = &edges->items[i];
-
-        printf("%s,%s,%s,%s,%s,%s,%s\n",
-               edge->src->id[0] ? edge->src->id : "",
-               edge->src->title ? edge->src->title : "",
-               edge->dst->id[0] ? edge->dst->id : "",
-               edge->dst->title ? edge->dst->title : "",
-               edge->label ? edge->label : "",
-               edge->src->path ? edge->src->path : "",
-               edge->dst->path ? edge->dst->path : "");
+        const char *row[] = {
+            edge->src->id, edge->src->title, edge->dst->id, edge->dst->title,
+            edges->labels.strings[edge->label], edge->src->path, edge->dst->path
+        };
+
+        for (size_t j = 0; j < sizeof(row) / sizeof(row[0]); j++) {
+            if (j > 0) putc(',', out);
+            csv_write_field(out, row[j]);
+        }
+        putc('\n', out);
     }
 }
 
@@ -297,111 +302,66 @@ void print_edges_csv(EdgeList *edges) {
 void free_edges(EdgeList *edges) {
     if (edges == NULL) return;
 
-    for (int i = 0; i < edges->count; i++) {
-        free(edges->items[i].label);
-    }
     free(edges->items);
+    intern_release(&edges->labels);
     free(edges);
 }
 
-/**
- * Parse a CSV line into a Node
- * Expected format: id,title,path
- * Returns 0 on success, 1 on error
- */
-static int parse_node_csv_line(Node *node, const char *line) {
-    char *line_copy = strdup(line);
-    if (line_copy == NULL) {
-        return 1;
-    }
-
-    // Initialize node fields
-    node->id[0] = '\0';
-    node->title = NULL;
-    node->path = NULL;
-
-    // Parse CSV fields
-    char *token;
-    char *saveptr;
-    int field = 0;
-
-    token = strtok_r(line_copy, ",", &saveptr);
-    while (token != NULL && field < 3) {
-        switch (field) {
-            case 0:  // id
-                strncpy(node->id, token, 36);
-                node->id[36] = '\0';
-                break;
-            case 1:  // title
-                if (strlen(token) > 0) {
-                    node->title = strdup(token);
-                }
-                break;
-            case 2:  // path
-                if (strlen(token) > 0) {
-                    node->path = strdup(token);
-                }
-                break;
-        }
-        field++;
-        token = strtok_r(NULL, ",", &saveptr);
-    }
-
-    free(line_copy);
-    return 0;
-}
-
 /**
  * Read node CSV from stdin and build NodeList
+ * The input is loaded into the list's arena in one piece; titles and paths
+ * are slices of it
  * Returns NodeList* or NULL on error
  */
 static NodeList* read_nodes_from_csv(void) {
-    char line[PATH_MAX];
+    char *fields[3];
+    int field_count;
     int is_header = 1;
+    size_t len;
+    CsvReader reader;
 
-    NodeList *list = malloc(sizeof(NodeList));
+    NodeList *list = calloc(1, sizeof(NodeList));
     if (list == NULL) {
         fprintf(stderr, "Failed to allocate NodeList\n");
         return NULL;
     }
-    list->items = NULL;
-    list->count = 0;
 
-    while (fgets(line, sizeof(line), stdin) != NULL) {
+    char *data = arena_read_stream(&list->arena, stdin, &len);
+    if (data == NULL) {
+        fprintf(stderr, "Failed to read node CSV\n");
+        free_nodes(list);
+        return NULL;
+    }
+
+    csv_reader_init(&reader, data, len);
+    while ((field_count = csv_read_row(&reader, fields, 3)) != -1) {
         // Skip header line
         if (is_header) {
             is_header = 0;
             continue;
         }
 
-        // Remove trailing newline
-        line[strcspn(line, "\n")] = '\0';
-
         // Skip empty lines
-        if (strlen(line) == 0) {
+        if (field_count == 1 && fields[0][0] == '\0') {
             continue;
         }
 
         // Grow array
-        Node *tmp = realloc(list->items, (list->count + 1) * sizeof(Node));
-        if (tmp == NULL) {
+        if (vector_reserve((void**)&list->items, &list->cap, list->count + 1,
+                           sizeof(Node)) != 0) {
             fprintf(stderr, "Failed to allocate memory for nodes\n");
-            // Free existing nodes
-            for (int i = 0; i < list->count; i++) {
-                free(list->items[i].title);
-                free(list->items[i].path);
-            }
-            free(list->items);
-            free(list);
+            free_nodes(list);
             return NULL;
         }
-        list->items = tmp;
 
-        // Parse node from CSV line
+        // Columns: id,title,path (id truncated to 36 bytes)
         Node *node = &list->items[list->count];
-        if (parse_node_csv_line(node, line) != 0) {
-            continue;  // Skip malformed lines
-        }
+        size_t id_len = strnlen(fields[0], 36);
+        memcpy(node->id, fields[0], id_len);
+        node->id[id_len] = '\0';
+        node->title = field_count > 1 && fields[1][0] != '\0' ? fields[1] : NULL;
+        node->path = field_count > 2 && fields[2][0] != '\0' ? fields[2] : NULL;
+        node->values = NULL;
 
         list->count++;
     }
@@ -409,52 +369,80 @@ static NodeList* read_nodes_from_csv(void) {
     return list;
 }
 
-/**
- * Free nodes read from CSV
- */
-static void free_csv_nodes(NodeList *list) {
-    if (list == NULL) return;
-
-    for (int i = 0; i < list->count; i++) {
-        free(list->items[i].title);
-        free(list->items[i].path);
-    }
-    free(list->items);
-    free(list);
-}
-
 /**
  * Entry point for edges command
  * Expects node CSV on stdin, outputs edge CSV
  */
 int edges(int argc, char **argv) {
+    FrontmatterCache *cache = NULL;
+    int use_cache = 0;
+    int binary = 0;
+    int status = 0;
+    NodeList *nodes;
+
     // Parse arguments
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             help();
             return 0;
+        } else if (strcmp(argv[i], "--cache") == 0) {
+            use_cache = 1;
+        } else if (strcmp(argv[i], "--format") == 0) {
+            // Next argument should be the output format
+            if (i + 1 < argc && strcmp(argv[i + 1], "csv") == 0) {
+                binary = 0;
+            } else if (i + 1 < argc && strcmp(argv[i + 1], "bin") == 0) {
+                binary = 1;
+            } else {
+                fprintf(stderr, "Error: --format requires csv or bin\n");
+                return 1;
+            }
+            i++; // Skip next argument
         }
     }
 
-    // Read nodes from CSV stdin
-    NodeList *nodes = read_nodes_from_csv();
-    if (nodes == NULL) {
-        return 1;
+    // Read nodes from stdin: binary stream or CSV
+    if (graph_is_binary(stdin)) {
+        if (graph_read(stdin, &nodes, NULL) != 0) {
+            return 1;
+        }
+    } else {
+        nodes = read_nodes_from_csv();
+        if (nodes == NULL) {
+            return 1;
+        }
+    }
+
+    if (use_cache) {
+        cache = frontmatter_cache_open();
+        if (cache == NULL) {
+            free_nodes(nodes);
+            return 1;
+        }
     }
 
     // Build edges from nodes
-    EdgeList *edge_list = build_edges_from_nodes(nodes);
+    EdgeList *edge_list = build_edges_from_nodes(nodes, cache);
     if (edge_list == NULL) {
-        free_csv_nodes(nodes);
+        frontmatter_cache_close(cache);
+        free_nodes(nodes);
         return 1;
     }
 
-    // Print edges as CSV
-    print_edges_csv(edge_list);
+    // Print edges as CSV, or nodes and edges as binary stream
+    if (binary) {
+        status = graph_write(stdout, nodes, edge_list);
+    } else {
+        print_edges_csv(stdout, edge_list);
+    }
 
     // Cleanup
     free_edges(edge_list);
-    free_csv_nodes(nodes);
+    free_nodes(nodes);
+    if (cache != NULL) {
+        status |= frontmatter_cache_save(cache);
+        frontmatter_cache_close(cache);
+    }
 
-    return 0;
+    return status;
 }
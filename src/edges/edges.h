@@ -1,7 +1,9 @@
 #ifndef EDGES_H
 #define EDGES_H
 
+#include "alloc/alloc.h"
 #include "nodes/nodes.h"
+#include "frontmatter/cache.h"
 
 /**
  * Represents a markdown link extracted from file content
@@ -12,9 +14,20 @@ typedef struct {
     char *label;     // Extracted label (e.g., "parent") or default "link"
 } Link;
 
+/**
+ * Dynamic array of links
+ *
+ * Fields:
+ *   items - Array of Link structures
+ *   count - Number of links in the array
+ *   cap   - Allocated length of items
+ *   arena - Holds the text, path and label strings of all links
+ */
 typedef struct {
     Link *items;
     int count;
+    int cap;
+    Arena arena;
 } LinkList;
 
 /**
@@ -23,38 +36,65 @@ typedef struct {
  * Fields:
  *   src   - Pointer to source node
  *   dst   - Pointer to destination node
- *   label - Edge label (typically "parent")
+ *   label - Id of the edge label (typically "parent") in the EdgeList
+ *           labels table; equal labels have equal ids
  */
 typedef struct {
     Node *src;
     Node *dst;
-    char *label;
+    int label;
 } Edge;
 
 /**
  * Dynamic array of edges
  *
  * Fields:
- *   items - Array of Edge structures
- *   count - Number of edges in the array
+ *   items  - Array of Edge structures
+ *   count  - Number of edges in the array
+ *   cap    - Allocated length of items
+ *   labels - Interned edge labels; each distinct label is stored once
  */
 typedef struct {
     Edge *items;
     int count;
+    int cap;
+    StringTable labels;
 } EdgeList;
 
+/**
+ * Extract all markdown links [text](url) from len bytes of content
+ * (not NUL-terminated); label comes from ?label= in the url, or "link"
+ * Returns LinkList* or NULL on error
+ */
+LinkList* extract_links_from_content(const char *content, size_t len);
+
+/**
+ * Free link list memory
+ */
+void free_links(LinkList *list);
+
+/**
+ * Add an edge from src to the node each link points to
+ * A link points to the first node whose path ends with the link's path
+ * at a segment boundary (query string removed, see find_node_by_path());
+ * links to other files are skipped. nodes must be indexed (index_nodes())
+ * Returns 0 on success, 1 on allocation failure
+ */
+int add_link_edges(EdgeList *edges, NodeList *nodes, Node *src, const LinkList *links);
+
 /**
  * Build edge list from node list by matching parent links
  * Creates directed edges from nodes to their parents
+ * cache (--cache) may be NULL; nodes are indexed (index_nodes()) first
  * Returns EdgeList* or NULL on error
  */
-EdgeList* build_edges_from_nodes(NodeList *nodes);
+EdgeList* build_edges_from_nodes(NodeList *nodes, FrontmatterCache *cache);
 
 /**
- * Print edges as CSV to stdout
+ * Print edges as CSV to out
  * Format: src_id,src_title,dst_id,dst_title,label,src_path,dst_path
  */
-void print_edges_csv(EdgeList *edges);
+void print_edges_csv(FILE *out, EdgeList *edges);
 
 /**
  * Free edge list memory
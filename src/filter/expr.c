@@ -0,0 +1,398 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "expr.h"
+
+typedef enum {
+    TOK_END,
+    TOK_WORD,     // Bare key or value
+    TOK_STRING,   // "..." or '...' value, quotes excluded
+    TOK_LPAREN,
+    TOK_RPAREN,
+    TOK_COMMA,
+    TOK_NOT,
+    TOK_AND,
+    TOK_OR,
+    TOK_EQUAL,
+    TOK_NOT_EQUAL,
+    TOK_INVALID
+} TokenKind;
+
+typedef struct {
+    TokenKind kind;
+    const char *text;
+    size_t len;
+    size_t column;
+} Token;
+
+/**
+ * Recursive-descent parser state; emits bytecode as it goes
+ */
+typedef struct {
+    const char *source;
+    const char *p;
+    Token token;          // Current (not yet consumed) token
+    ExprProgram *program;
+    int code_cap;
+} Parser;
+
+static int is_word_char(char c) {
+    return c != '\0' && !isspace((unsigned char)c) && strchr("()!,=&|\"'", c) == NULL;
+}
+
+/**
+ * Read the next token into parser->token
+ */
+static void next_token(Parser *parser) {
+    const char *p = parser->p;
+    Token *token = &parser->token;
+
+    while (isspace((unsigned char)*p)) p++;
+    token->text = p;
+    token->len = 1;
+    token->column = (p - parser->source) + 1;
+
+    if (*p == '\0') {
+        token->kind = TOK_END;
+        token->len = 0;
+    } else if (*p == '(') {
+        token->kind = TOK_LPAREN;
+    } else if (*p == ')') {
+        token->kind = TOK_RPAREN;
+    } else if (*p == ',') {
+        token->kind = TOK_COMMA;
+    } else if (p[0] == '&' && p[1] == '&') {
+        token->kind = TOK_AND;
+        token->len = 2;
+    } else if (p[0] == '|' && p[1] == '|') {
+        token->kind = TOK_OR;
+        token->len = 2;
+    } else if (p[0] == '=' && p[1] == '=') {
+        token->kind = TOK_EQUAL;
+        token->len = 2;
+    } else if (p[0] == '!' && p[1] == '=') {
+        token->kind = TOK_NOT_EQUAL;
+        token->len = 2;
+    } else if (*p == '!') {
+        token->kind = TOK_NOT;
+    } else if (*p == '"' || *p == '\'') {
+        const char *close = strchr(p + 1, *p);
+        if (close == NULL) {
+            token->kind = TOK_INVALID;
+        } else {
+            token->kind = TOK_STRING;
+            token->text = p + 1;
+            token->len = close - (p + 1);
+            parser->p = close + 1;
+            return;
+        }
+    } else if (is_word_char(*p)) {
+        const char *end = p;
+        while (is_word_char(*end)) end++;
+        token->kind = TOK_WORD;
+        token->len = end - p;
+    } else {
+        token->kind = TOK_INVALID;
+    }
+
+    parser->p = p + token->len;
+}
+
+static int syntax_error(Parser *parser, const char *expected) {
+    if (parser->token.kind == TOK_END) {
+        fprintf(stderr, "Error: Invalid -w expression '%s': expected %s at end\n",
+                parser->source, expected);
+    } else {
+        fprintf(stderr, "Error: Invalid -w expression '%s': expected %s at column %zu\n",
+                parser->source, expected, parser->token.column);
+    }
+    return 1;
+}
+
+static int token_is(const Token *token, const char *word) {
+    size_t len = strlen(word);
+    return token->kind == TOK_WORD && token->len == len && memcmp(token->text, word, len) == 0;
+}
+
+static int emit(Parser *parser, ExprOpcode opcode, int operand) {
+    ExprProgram *program = parser->program;
+
+    if (program->code_len == parser->code_cap) {
+        int new_cap = parser->code_cap ? parser->code_cap * 2 : 16;
+        ExprInstruction *tmp = realloc(program->code, new_cap * sizeof(ExprInstruction));
+        if (tmp == NULL) {
+            fprintf(stderr, "Failed to allocate memory for -w expression\n");
+            return 1;
+        }
+        program->code = tmp;
+        parser->code_cap = new_cap;
+    }
+
+    program->code[program->code_len].opcode = opcode;
+    program->code[program->code_len].operand = operand;
+    program->code_len++;
+    return 0;
+}
+
+/**
+ * Add a test for key (copied) and emit the instruction that pushes its result
+ * Returns the new test, or NULL on error (message printed to stderr)
+ */
+static ExprTest* add_test(Parser *parser, ExprTestKind kind, const Token *key) {
+    ExprProgram *program = parser->program;
+
+    if (program->test_count == EXPR_MAX_TESTS) {
+        fprintf(stderr, "Error: -w expression has more than %d comparisons\n", EXPR_MAX_TESTS);
+        return NULL;
+    }
+
+    ExprTest *test = &program->tests[program->test_count];
+    memset(test, 0, sizeof(*test));
+    test->kind = kind;
+    test->key = strndup(key->text, key->len);
+    test->key_len = key->len;
+    if (test->key == NULL) {
+        fprintf(stderr, "Failed to allocate memory for -w expression\n");
+        return NULL;
+    }
+    program->test_count++;
+
+    if (emit(parser, OP_TEST, program->test_count - 1) != 0) {
+        return NULL;
+    }
+    return test;
+}
+
+/**
+ * Append the current token (a word or quoted string) to the test's values
+ */
+static int add_value(Parser *parser, ExprTest *test) {
+    const Token *token = &parser->token;
+
+    if (token->kind != TOK_WORD && token->kind != TOK_STRING) {
+        return syntax_error(parser, "a value");
+    }
+
+    char **values = realloc(test->values, (test->value_count + 1) * sizeof(char*));
+    if (values == NULL) {
+        fprintf(stderr, "Failed to allocate memory for -w expression\n");
+        return 1;
+    }
+    test->values = values;
+
+    size_t *lens = realloc(test->value_lens, (test->value_count + 1) * sizeof(size_t));
+    if (lens == NULL) {
+        fprintf(stderr, "Failed to allocate memory for -w expression\n");
+        return 1;
+    }
+    test->value_lens = lens;
+
+    char *value = strndup(token->text, token->len);
+    if (value == NULL) {
+        fprintf(stderr, "Failed to allocate memory for -w expression\n");
+        return 1;
+    }
+
+    test->values[test->value_count] = value;
+    test->value_lens[test->value_count] = token->len;
+    test->value_count++;
+    next_token(parser);
+    return 0;
+}
+
+static int parse_or(Parser *parser);
+
+/**
+ * primary := "(" or ")" | "has" "(" key ")" | key ("==" | "!=") value
+ *          | key "in" "(" value ("," value)* ")"
+ */
+static int parse_primary(Parser *parser) {
+    if (parser->token.kind == TOK_LPAREN) {
+        next_token(parser);
+        if (parse_or(parser) != 0) return 1;
+        if (parser->token.kind != TOK_RPAREN) return syntax_error(parser, "')'");
+        next_token(parser);
+        return 0;
+    }
+
+    if (parser->token.kind != TOK_WORD && parser->token.kind != TOK_STRING) {
+        return syntax_error(parser, "a key, 'has(', '!' or '('");
+    }
+    Token key = parser->token;
+    next_token(parser);
+
+    if (token_is(&key, "has") && parser->token.kind == TOK_LPAREN) {
+        next_token(parser);
+        if (parser->token.kind != TOK_WORD && parser->token.kind != TOK_STRING) {
+            return syntax_error(parser, "a key");
+        }
+        if (add_test(parser, TEST_HAS, &parser->token) == NULL) return 1;
+        next_token(parser);
+        if (parser->token.kind != TOK_RPAREN) return syntax_error(parser, "')'");
+        next_token(parser);
+        return 0;
+    }
+
+    if (parser->token.kind == TOK_EQUAL || parser->token.kind == TOK_NOT_EQUAL) {
+        int negate = parser->token.kind == TOK_NOT_EQUAL;
+        next_token(parser);
+        ExprTest *test = add_test(parser, TEST_EQUAL, &key);
+        if (test == NULL || add_value(parser, test) != 0) return 1;
+        return negate ? emit(parser, OP_NOT, 0) : 0;
+    }
+
+    if (token_is(&parser->token, "in")) {
+        next_token(parser);
+        if (parser->token.kind != TOK_LPAREN) return syntax_error(parser, "'(' after 'in'");
+        next_token(parser);
+        ExprTest *test = add_test(parser, TEST_IN, &key);
+        if (test == NULL || add_value(parser, test) != 0) return 1;
+        while (parser->token.kind == TOK_COMMA) {
+            next_token(parser);
+            if (add_value(parser, test) != 0) return 1;
+        }
+        if (parser->token.kind != TOK_RPAREN) return syntax_error(parser, "',' or ')'");
+        next_token(parser);
+        return 0;
+    }
+
+    return syntax_error(parser, "'==', '!=' or 'in' after key");
+}
+
+/**
+ * unary := "!" unary | primary
+ */
+static int parse_unary(Parser *parser) {
+    if (parser->token.kind == TOK_NOT) {
+        next_token(parser);
+        if (parse_unary(parser) != 0) return 1;
+        return emit(parser, OP_NOT, 0);
+    }
+    return parse_primary(parser);
+}
+
+/**
+ * and := unary ("&&" unary)*
+ */
+static int parse_and(Parser *parser) {
+    if (parse_unary(parser) != 0) return 1;
+    while (parser->token.kind == TOK_AND) {
+        next_token(parser);
+        if (parse_unary(parser) != 0 || emit(parser, OP_AND, 0) != 0) return 1;
+    }
+    return 0;
+}
+
+/**
+ * or := and ("||" and)*
+ */
+static int parse_or(Parser *parser) {
+    if (parse_and(parser) != 0) return 1;
+    while (parser->token.kind == TOK_OR) {
+        next_token(parser);
+        if (parse_and(parser) != 0 || emit(parser, OP_OR, 0) != 0) return 1;
+    }
+    return 0;
+}
+
+/**
+ * Compile an expression such as "draft == false && lang in (en,pl) && has(slug)"
+ * Returns 0 on success, 1 on error (message printed to stderr)
+ */
+int expr_compile(const char *source, ExprProgram *program) {
+    Parser parser = {0};
+
+    memset(program, 0, sizeof(*program));
+    parser.source = source;
+    parser.p = source;
+    parser.program = program;
+    next_token(&parser);
+
+    if (parse_or(&parser) != 0) {
+        expr_free(program);
+        return 1;
+    }
+    if (parser.token.kind != TOK_END) {
+        syntax_error(&parser, "'&&', '||' or end of expression");
+        expr_free(program);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Free a compiled expression
+ */
+void expr_free(ExprProgram *program) {
+    for (int i = 0; i < program->test_count; i++) {
+        ExprTest *test = &program->tests[i];
+        for (int j = 0; j < test->value_count; j++) {
+            free(test->values[j]);
+        }
+        free(test->values);
+        free(test->value_lens);
+        free(test->key);
+    }
+    free(program->code);
+    memset(program, 0, sizeof(*program));
+}
+
+/**
+ * Record which tests one frontmatter entry passes
+ */
+void expr_observe(const ExprProgram *program, const FrontmatterEntry *entry, uint64_t *results) {
+    for (int i = 0; i < program->test_count; i++) {
+        const ExprTest *test = &program->tests[i];
+        uint64_t bit = (uint64_t)1 << i;
+
+        if ((*results & bit) || test->key_len != entry->key_len ||
+            memcmp(test->key, entry->key, entry->key_len) != 0) {
+            continue;
+        }
+
+        if (test->kind == TEST_HAS) {
+            *results |= bit;
+            continue;
+        }
+        for (int j = 0; j < test->value_count; j++) {
+            if (test->value_lens[j] == entry->value_len &&
+                memcmp(test->values[j], entry->value, entry->value_len) == 0) {
+                *results |= bit;
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * Evaluate the expression for a file from its test results
+ * Returns 1 if the file passes, 0 otherwise
+ */
+int expr_run(const ExprProgram *program, uint64_t results) {
+    // Only OP_TEST pushes, so the stack never holds more than test_count values
+    uint8_t stack[EXPR_MAX_TESTS];
+    int depth = 0;
+
+    for (int i = 0; i < program->code_len; i++) {
+        const ExprInstruction *instruction = &program->code[i];
+        switch (instruction->opcode) {
+            case OP_TEST:
+                stack[depth++] = (results >> instruction->operand) & 1;
+                break;
+            case OP_NOT:
+                stack[depth - 1] = !stack[depth - 1];
+                break;
+            case OP_AND:
+                depth--;
+                stack[depth - 1] = stack[depth - 1] && stack[depth];
+                break;
+            case OP_OR:
+                depth--;
+                stack[depth - 1] = stack[depth - 1] || stack[depth];
+                break;
+        }
+    }
+
+    return depth == 1 && stack[0];
+}
@@ -0,0 +1,96 @@
+#ifndef EXPR_H
+#define EXPR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "frontmatter/frontmatter.h"
+
+// Comparisons per expression; their results fit in one uint64_t
+#define EXPR_MAX_TESTS 64
+
+/**
+ * Kind of comparison against one frontmatter key
+ */
+typedef enum {
+    TEST_HAS,     // has(key): key is present
+    TEST_EQUAL,   // key == value (and key != value, negated)
+    TEST_IN       // key in (value, ...)
+} ExprTestKind;
+
+/**
+ * One comparison of a -w expression
+ *
+ * A test is true if any field or list item with this key passes it.
+ *
+ * Fields:
+ *   key, key_len - Frontmatter key
+ *   values       - Accepted values (unquoted); unused for TEST_HAS
+ *   value_lens   - Length of each value
+ *   value_count  - 1 for TEST_EQUAL, one or more for TEST_IN
+ */
+typedef struct {
+    ExprTestKind kind;
+    char *key;
+    size_t key_len;
+    char **values;
+    size_t *value_lens;
+    int value_count;
+} ExprTest;
+
+/**
+ * Bytecode instructions, run as a stack machine over test results
+ */
+typedef enum {
+    OP_TEST,      // Push the result of tests[operand]
+    OP_NOT,       // Negate the top of the stack
+    OP_AND,       // Pop two, push both true
+    OP_OR         // Pop two, push either true
+} ExprOpcode;
+
+typedef struct {
+    uint8_t opcode;
+    uint8_t operand;
+} ExprInstruction;
+
+/**
+ * Compiled -w expression
+ *
+ * Frontmatter entries are fed to expr_observe() as the file is scanned,
+ * which sets one bit per passing test; expr_run() then evaluates the
+ * bytecode against those bits without looking at the file again.
+ *
+ * Fields:
+ *   tests      - Comparisons, indexed by OP_TEST operands
+ *   code       - Instructions in postfix order
+ */
+typedef struct {
+    ExprTest tests[EXPR_MAX_TESTS];
+    int test_count;
+    ExprInstruction *code;
+    int code_len;
+} ExprProgram;
+
+/**
+ * Compile an expression such as "draft == false && lang in (en,pl) && has(slug)"
+ * Returns 0 on success, 1 on error (message printed to stderr)
+ */
+int expr_compile(const char *source, ExprProgram *program);
+
+/**
+ * Free a compiled expression
+ */
+void expr_free(ExprProgram *program);
+
+/**
+ * Record which tests one frontmatter entry passes
+ * results must start at 0 for each file
+ */
+void expr_observe(const ExprProgram *program, const FrontmatterEntry *entry, uint64_t *results);
+
+/**
+ * Evaluate the expression for a file from its test results
+ * Returns 1 if the file passes, 0 otherwise
+ */
+int expr_run(const ExprProgram *program, uint64_t results);
+
+#endif /* EXPR_H */
@@ -2,9 +2,61 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <regex.h>
 #include <limits.h>
+#include <pthread.h>
 #include "filter.h"
+#include "frontmatter/frontmatter.h"
+#include "frontmatter/cache.h"
+#include "frontmatter/reader.h"
+#include "expr.h"
+
+#define MAX_THREADS 256
+#define REORDER_WINDOW 1024
+
+/**
+ * One path in flight with --threads, indexed by input position
+ *
+ * Fields:
+ *   path  - Path as read from stdin (owned)
+ *   done  - A worker has finished validating it
+ *   valid - Result of validate_file()
+ */
+typedef struct {
+    char *path;
+    int done;
+    int valid;
+} FilterSlot;
+
+/**
+ * Reorder buffer shared by the reading thread and the workers
+ * Input positions map to slots modulo REORDER_WINDOW; next_read and
+ * next_output are only written by the reading thread
+ *
+ * Fields:
+ *   next_read   - Position of the next path read from stdin
+ *   next_job    - Position of the next path a worker takes
+ *   next_output - Position of the next path to print
+ *   eof         - stdin is exhausted
+ *   where       - Compiled -w expression (read-only), or NULL
+ *   cache       - Parsed-note cache (--cache), or NULL
+ */
+typedef struct {
+    FilterSlot *slots;
+    long next_read;
+    long next_job;
+    long next_output;
+    int eof;
+    const ExprProgram *where;
+    FrontmatterCache *cache;
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;   // A path was queued or stdin ended
+    pthread_cond_t done_cond;   // A worker finished a path
+} FilterPool;
+
+typedef struct {
+    FilterPool *pool;
+    pthread_t thread;
+} FilterWorker;
 
 /**
  * Display help message following Unix conventions
@@ -22,11 +74,88 @@ static void help(void) {
     printf("  - title property\n");
     printf("\n");
     printf("Options:\n");
-    printf("  -h, --help     Display this help and exit\n");
+    printf("  -h, --help         Display this help and exit\n");
+    printf("  -0, --null         Read and write NUL-separated paths (jig find -0)\n");
+    printf("  -w, --where EXPR   Also require the frontmatter to satisfy EXPR\n");
+    printf("  -t, --threads N    Validate files with N worker threads (default: 1)\n");
+    printf("      --cache        Reuse frontmatter parsed by earlier runs (%s)\n",
+           FRONTMATTER_CACHE_FILE);
+    printf("\n");
+    printf("Expressions:\n");
+    printf("  key == value, key != value   Compare a field (or any item of a list)\n");
+    printf("  key in (v1, v2, ...)         Field equals one of the values\n");
+    printf("  has(key)                     Field is present\n");
+    printf("  !, &&, ||, ( )               Combine comparisons\n");
     printf("\n");
     printf("Examples:\n");
     printf("  jig filter note.md              Validate single file\n");
     printf("  find . -name \"*.md\" | jig filter  Filter multiple files\n");
+    printf("  jig find -0 . | jig filter -0     Paths may contain newlines\n");
+    printf("  jig find . | jig filter -t 8      Same output, validated by 8 threads\n");
+    printf("  jig find . | jig filter -w 'draft == false && lang in (en,pl)'\n");
+    printf("  jig find . | jig filter --cache   Skip unchanged notes on later runs\n");
+}
+
+/**
+ * Check a file's frontmatter
+ * Stops at the first id and title unless a -w expression (where != NULL)
+ * or full requires the whole frontmatter to be scanned
+ * Returns 1 if valid, 0 otherwise
+ */
+static int check_frontmatter(const char *data, size_t len, const ExprProgram *where, int full) {
+    FrontmatterLexer lexer;
+    FrontmatterEntry entry;
+    uint64_t results = 0;
+    int has_id = 0;
+    int has_title = 0;
+    int invalid = 0;
+
+    // Check for YAML frontmatter (must start with ---)
+    if (frontmatter_begin(&lexer, data, len) != 0) {
+        return 0;
+    }
+
+    // First id and title win; the body after the closing --- is never scanned
+    while (frontmatter_next(&lexer, &entry)) {
+        if (where != NULL) {
+            expr_observe(where, &entry, &results);
+        }
+        if (entry.kind != FRONTMATTER_FIELD) continue;
+
+        if (!has_id && frontmatter_key_is(&entry, "id")) {
+            // Validate id length (max 36 bytes)
+            if (entry.value_len == 0 || entry.value_len > 36) {
+                if (!full) return 0;
+                invalid = 1;
+            }
+            has_id = 1;
+        } else if (!has_title && frontmatter_key_is(&entry, "title")) {
+            if (entry.value_len == 0) {
+                if (!full) return 0;
+                invalid = 1;
+            }
+            has_title = 1;
+        }
+
+        if (has_id && has_title && where == NULL && !full) {
+            // All criteria met
+            return 1;
+        }
+    }
+
+    return !invalid && has_id && has_title && (where == NULL || expr_run(where, results));
+}
+
+/**
+ * Judge a note from its cached frontmatter fields, like check_frontmatter()
+ * Returns 1 if valid, 0 otherwise
+ */
+static int check_cached(const CachedNote *note) {
+    if (!(note->flags & CACHED_FRONTMATTER) || note->id == NULL || note->title == NULL) {
+        return 0;
+    }
+    size_t id_len = strlen(note->id);
+    return id_len > 0 && id_len <= 36 && note->title[0] != '\0';
 }
 
 /**
@@ -34,133 +163,319 @@ static void help(void) {
  * - Has YAML frontmatter (starts with ---)
  * - Has id property (max 36 bytes)
  * - Has title property
+ * The file is opened as a FileView: large files are mapped and only the
+ * pages holding the frontmatter are read in
+ * where is the compiled -w expression, or NULL
+ * With cache, unchanged files are judged from their cached fields; other
+ * files have their whole frontmatter scanned and stored
  * Returns 1 if valid, 0 otherwise
  */
-static int validate_file(const char *filepath) {
-    FILE *fptr;
-    long filesize;
-    char *filecontent;
-    int is_valid = 0;
-    regex_t rgx_id, rgx_title;
-    int rgx_result;
-
-    // Open file
-    if ((fptr = fopen(filepath, "r")) == NULL) {
+static int validate_file(const char *filepath, const ExprProgram *where, FrontmatterCache *cache) {
+    NoteKey key;
+    CachedNote note;
+    FileView view;
+
+    if (cache != NULL &&
+        frontmatter_cache_lookup(cache, filepath, &key, &note) == 0 &&
+        (note.flags & CACHED_FIELDS)) {
+        return check_cached(&note);
+    }
+
+    if (file_view_open(&view, filepath) != 0) {
         return 0;
     }
 
-    // Get file size
-    fseek(fptr, 0L, SEEK_END);
-    filesize = ftell(fptr);
-    fseek(fptr, 0L, SEEK_SET);
+    int result = check_frontmatter(view.data, view.len, where, cache != NULL);
 
-    // Read file content
-    filecontent = malloc(filesize + 1);
-    if (filecontent == NULL) {
-        fclose(fptr);
-        return 0;
+    if (cache != NULL) {
+        FrontmatterFields fields;
+        int has_frontmatter = frontmatter_fields(view.data, view.len, &fields) == 0;
+        frontmatter_cache_store_fields(cache, &key, has_frontmatter, &fields);
     }
 
-    for (long j = 0; j < filesize; j++) {
-        filecontent[j] = fgetc(fptr);
+    file_view_close(&view);
+    return result;
+}
+
+/**
+ * Validate paths from stdin one at a time
+ * Paths are separated by delimiter; accepted ones are printed with it
+ */
+static void filter_serial(char delimiter, const ExprProgram *where, FrontmatterCache *cache) {
+    char *filepath = NULL;
+    size_t filepath_cap = 0;
+    ssize_t len;
+
+    // Read filepaths from stdin, one per record
+    while ((len = getdelim(&filepath, &filepath_cap, delimiter, stdin)) != -1) {
+        // Remove trailing delimiter
+        if (len > 0 && filepath[len - 1] == delimiter) {
+            filepath[len - 1] = '\0';
+        }
+
+        // Validate and output path, keeping the input separator
+        if (validate_file(filepath, where, cache)) {
+            fputs(filepath, stdout);
+            putchar(delimiter);
+        }
     }
-    filecontent[filesize] = '\0';
+    free(filepath);
+}
 
-    fclose(fptr);
+/**
+ * Take the next queued path, validate it and mark its slot done
+ * Exits once stdin is exhausted and every path has been taken
+ */
+static void* filter_worker(void *arg) {
+    FilterWorker *worker = arg;
+    FilterPool *pool = worker->pool;
 
-    // Check for YAML frontmatter (must start with ---)
-    if (strncmp(filecontent, "---", 3) != 0) {
-        free(filecontent);
-        return 0;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->next_job == pool->next_read && !pool->eof) {
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        }
+        if (pool->next_job == pool->next_read) {
+            break;
+        }
+        FilterSlot *slot = &pool->slots[pool->next_job % REORDER_WINDOW];
+        pool->next_job++;
+        pthread_mutex_unlock(&pool->lock);
+
+        int valid = validate_file(slot->path, pool->where, pool->cache);
+
+        pthread_mutex_lock(&pool->lock);
+        slot->valid = valid;
+        slot->done = 1;
+        pthread_cond_signal(&pool->done_cond);
     }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
 
-    // Compile regex patterns
-    if (regcomp(&rgx_id, "id:[ \t]*([^ \t\r\n]+)", REG_EXTENDED | REG_ICASE | REG_NEWLINE) != 0) {
-        free(filecontent);
-        return 0;
+/**
+ * Print the finished paths at the head of the reorder buffer, in input order
+ * With wait set, first blocks until the oldest path is finished
+ * Only the reading thread calls this, so next_output needs no lock
+ */
+static void flush_results(FilterPool *pool, char delimiter, int wait) {
+    long end = pool->next_output;
+
+    pthread_mutex_lock(&pool->lock);
+    while (wait && end < pool->next_read && !pool->slots[end % REORDER_WINDOW].done) {
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    }
+    while (end < pool->next_read && pool->slots[end % REORDER_WINDOW].done) {
+        end++;
     }
+    pthread_mutex_unlock(&pool->lock);
 
-    if (regcomp(&rgx_title, "title:[ \t]*([^ \t\r\n]+)", REG_EXTENDED | REG_ICASE | REG_NEWLINE) != 0) {
-        regfree(&rgx_id);
-        free(filecontent);
-        return 0;
+    // Finished slots are not touched by workers again until they are refilled
+    for (long seq = pool->next_output; seq < end; seq++) {
+        FilterSlot *slot = &pool->slots[seq % REORDER_WINDOW];
+        if (slot->valid) {
+            fputs(slot->path, stdout);
+            putchar(delimiter);
+        }
+        free(slot->path);
+        slot->path = NULL;
     }
+    pool->next_output = end;
+}
 
-    // Check for id property
-    regmatch_t rgx_id_matches[2];
-    rgx_result = regexec(&rgx_id, filecontent, 2, rgx_id_matches, 0);
+/**
+ * Validate paths from stdin with a pool of worker threads
+ * Up to REORDER_WINDOW paths are in flight; results are printed in input
+ * order, so the output is identical to filter_serial()
+ * Returns 0 on success, 1 on error
+ */
+static int filter_parallel(char delimiter, int threads, const ExprProgram *where,
+                           FrontmatterCache *cache) {
+    FilterPool pool = {0};
+    FilterWorker *workers = calloc(threads, sizeof(FilterWorker));
+    int started = 0;
+    int status = 0;
 
-    if (rgx_result == REG_NOMATCH) {
-        regfree(&rgx_id);
-        regfree(&rgx_title);
-        free(filecontent);
-        return 0;
+    pool.where = where;
+    pool.cache = cache;
+    pool.slots = calloc(REORDER_WINDOW, sizeof(FilterSlot));
+    if (workers == NULL || pool.slots == NULL) {
+        fprintf(stderr, "Failed to allocate memory for filter workers\n");
+        free(workers);
+        free(pool.slots);
+        return 1;
     }
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.work_cond, NULL);
+    pthread_cond_init(&pool.done_cond, NULL);
 
-    // Validate id length (max 36 bytes)
-    int id_length = rgx_id_matches[1].rm_eo - rgx_id_matches[1].rm_so;
-    if (id_length > 36) {
-        regfree(&rgx_id);
-        regfree(&rgx_title);
-        free(filecontent);
-        return 0;
+    // Each worker reads small files into its own FileView buffer
+    for (; started < threads; started++) {
+        FilterWorker *worker = &workers[started];
+        worker->pool = &pool;
+        if (pthread_create(&worker->thread, NULL, filter_worker, worker) != 0) {
+            fprintf(stderr, "Failed to start worker thread\n");
+            break;
+        }
     }
 
-    // Check for title property
-    regmatch_t rgx_title_matches[2];
-    rgx_result = regexec(&rgx_title, filecontent, 2, rgx_title_matches, 0);
+    if (started == 0) {
+        // No worker: fall back to validating in this thread
+        filter_serial(delimiter, where, cache);
+    } else {
+        char *filepath = NULL;
+        size_t filepath_cap = 0;
+        ssize_t len;
 
-    if (rgx_result == REG_NOMATCH) {
-        regfree(&rgx_id);
-        regfree(&rgx_title);
-        free(filecontent);
-        return 0;
+        while ((len = getdelim(&filepath, &filepath_cap, delimiter, stdin)) != -1) {
+            // Remove trailing delimiter
+            if (len > 0 && filepath[len - 1] == delimiter) {
+                filepath[len - 1] = '\0';
+            }
+
+            // Reorder buffer full: wait for the oldest path
+            if (pool.next_read - pool.next_output == REORDER_WINDOW) {
+                flush_results(&pool, delimiter, 1);
+            }
+
+            FilterSlot *slot = &pool.slots[pool.next_read % REORDER_WINDOW];
+            slot->path = strdup(filepath);
+            if (slot->path == NULL) {
+                fprintf(stderr, "Failed to allocate memory for path\n");
+                status = 1;
+                break;
+            }
+            slot->done = 0;
+            slot->valid = 0;
+
+            pthread_mutex_lock(&pool.lock);
+            pool.next_read++;
+            pthread_cond_signal(&pool.work_cond);
+            pthread_mutex_unlock(&pool.lock);
+
+            flush_results(&pool, delimiter, 0);
+        }
+        free(filepath);
     }
 
-    // All criteria met
-    is_valid = 1;
+    pthread_mutex_lock(&pool.lock);
+    pool.eof = 1;
+    pthread_cond_broadcast(&pool.work_cond);
+    pthread_mutex_unlock(&pool.lock);
+
+    while (pool.next_output < pool.next_read) {
+        flush_results(&pool, delimiter, 1);
+    }
 
-    // Cleanup
-    regfree(&rgx_id);
-    regfree(&rgx_title);
-    free(filecontent);
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    pthread_cond_destroy(&pool.done_cond);
+    pthread_cond_destroy(&pool.work_cond);
+    pthread_mutex_destroy(&pool.lock);
+    free(pool.slots);
+    free(workers);
 
-    return is_valid;
+    return status;
 }
 
 int filter(int argc, char **argv) {
-    char filepath[PATH_MAX];
+    char delimiter = '\n';
+    const char *file = NULL;
+    const char *expression = NULL;
+    ExprProgram program;
+    const ExprProgram *where = NULL;
+    FrontmatterCache *cache = NULL;
+    int use_cache = 0;
+    int threads = 1;
+    int status = 0;
 
-    if (argc >= 2) {
-        // Check for help flag
-        if (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+    // Parse arguments
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             help();
             return 0;
+        } else if (strcmp(argv[i], "-0") == 0 || strcmp(argv[i], "--null") == 0) {
+            delimiter = '\0';
+        } else if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--where") == 0) {
+            // Next argument should be the expression
+            if (i + 1 < argc) {
+                expression = argv[i + 1];
+                i++; // Skip next argument
+            } else {
+                fprintf(stderr, "Error: -w/--where requires an expression argument\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--cache") == 0) {
+            use_cache = 1;
+        } else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threads") == 0) {
+            // Next argument should be the thread count
+            if (i + 1 < argc) {
+                char *end;
+                long count = strtol(argv[i + 1], &end, 10);
+                if (*end != '\0' || count < 1 || count > MAX_THREADS) {
+                    fprintf(stderr, "Error: -t/--threads must be between 1 and %d\n", MAX_THREADS);
+                    return 1;
+                }
+                threads = (int)count;
+                i++; // Skip next argument
+            } else {
+                fprintf(stderr, "Error: -t/--threads requires a number argument\n");
+                return 1;
+            }
+        } else if (file == NULL) {
+            file = argv[i];
         }
+    }
+
+    // The cache keeps id, title and slug only, not every field -w may test
+    if (use_cache && expression != NULL) {
+        fprintf(stderr, "Error: --cache cannot be combined with -w/--where\n");
+        return 1;
+    }
 
-        // Process single filepath from argv[1]
-        if (validate_file(argv[1])) {
-            printf("%s\n", argv[1]);
+    // Compile the expression once for all files
+    if (expression != NULL) {
+        if (expr_compile(expression, &program) != 0) {
+            return 1;
         }
-        return 0;
+        where = &program;
     }
 
-    // Check if stdin is a pipe (not a terminal)
-    if (!isatty(fileno(stdin))) {
-        // Read filepaths from stdin, one per line
-        while (fgets(filepath, sizeof(filepath), stdin) != NULL) {
-            // Remove trailing newline
-            filepath[strcspn(filepath, "\n")] = '\0';
+    if (use_cache) {
+        cache = frontmatter_cache_open();
+        if (cache == NULL) {
+            return 1;
+        }
+    }
 
-            // Validate and output path
-            if (validate_file(filepath)) {
-                printf("%s\n", filepath);
-            }
+    if (file != NULL) {
+        // Process single filepath from arguments
+        if (validate_file(file, where, cache)) {
+            fputs(file, stdout);
+            putchar(delimiter);
         }
-        return 0;
+    } else if (!isatty(fileno(stdin))) {
+        // stdin is a pipe (not a terminal)
+        if (threads > 1) {
+            status = filter_parallel(delimiter, threads, where, cache);
+        } else {
+            filter_serial(delimiter, where, cache);
+        }
+    } else {
+        // No input provided - show help to stderr and exit with error
+        help();
+        status = 1;
     }
 
-    // No input provided - show help to stderr and exit with error
-    help();
-    return 1;
+    if (cache != NULL) {
+        if (frontmatter_cache_save(cache) != 0) {
+            status = 1;
+        }
+        frontmatter_cache_close(cache);
+    }
+    if (where != NULL) {
+        expr_free(&program);
+    }
+    return status;
 }
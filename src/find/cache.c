@@ -0,0 +1,514 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "cache.h"
+
+#define CACHE_MAGIC "JIGFIND"
+#define CACHE_VERSION 2
+
+// Directories modified this recently are not cached: a change within the
+// same timestamp tick would otherwise go unnoticed on the next run
+#define CACHE_RACY_SECONDS 2
+
+/**
+ * File header, followed by:
+ *   CacheDirRecord[dir_count]   sorted by path (strcmp order)
+ *   ListingEntry[entry_count]   names are offsets into the string table
+ *   char[strings_size]          NUL-terminated paths and names
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t root_hash;
+    uint32_t dir_count;
+    uint32_t entry_count;
+    uint64_t strings_size;
+    uint64_t checksum;       // FNV-1a of everything after the header
+} CacheHeader;
+
+typedef struct {
+    uint64_t path;           // Offset into the string table
+    uint64_t dev;
+    uint64_t ino;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    uint32_t first_entry;
+    uint32_t entry_count;
+    uint32_t flags;          // Listing.flags (ignore files present)
+    uint32_t reserved;
+} CacheDirRecord;
+
+/**
+ * Directory visited during the current walk
+ * Either reuses a record of the loaded cache or owns a freshly read listing
+ */
+typedef struct {
+    size_t path;             // Offset into FindCache.paths
+    CacheDirRecord stat;     // dev, ino, mtime and flags (offsets unused)
+    int64_t old_index;       // Record in loaded cache, or -1 for a new listing
+    uint32_t first_entry;    // Into FindCache.new_entries (new listings only)
+    uint32_t entry_count;
+} VisitedDir;
+
+struct FindCache {
+    char file[PATH_MAX];
+    uint64_t root_hash;
+    time_t started;
+
+    // Loaded cache file (map is NULL if missing or invalid)
+    void *map;
+    size_t map_size;
+    const CacheDirRecord *dirs;
+    const ListingEntry *entries;
+    const char *strings;
+    uint32_t dir_count;
+
+    // Directories visited during this walk
+    VisitedDir *visited;
+    size_t visited_count;
+    size_t visited_cap;
+    char *paths;
+    size_t paths_len;
+    size_t paths_cap;
+    ListingEntry *new_entries;
+    size_t new_entry_count;
+    size_t new_entry_cap;
+    char *names;
+    size_t names_len;
+    size_t names_cap;
+    int dirty;
+};
+
+/**
+ * 64-bit FNV-1a hash
+ */
+static uint64_t fnv1a(const void *data, size_t len, uint64_t hash) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+
+/**
+ * Ensure buffer can hold need elements, growing geometrically
+ * Returns 0 on success, 1 on allocation failure
+ */
+static int reserve(void **buf, size_t *cap, size_t need, size_t elem_size) {
+    if (need <= *cap) return 0;
+
+    size_t new_cap = *cap ? *cap * 2 : 64;
+    while (new_cap < need) new_cap *= 2;
+
+    void *tmp = realloc(*buf, new_cap * elem_size);
+    if (tmp == NULL) return 1;
+    *buf = tmp;
+    *cap = new_cap;
+    return 0;
+}
+
+/**
+ * Validate mapped cache file and set up section pointers
+ * Returns 0 if the file is usable, 1 otherwise
+ */
+static int validate_map(FindCache *cache) {
+    const CacheHeader *header = cache->map;
+
+    if (cache->map_size < sizeof(CacheHeader)) return 1;
+    if (memcmp(header->magic, CACHE_MAGIC, sizeof(header->magic)) != 0) return 1;
+    if (header->version != CACHE_VERSION || header->header_size != sizeof(CacheHeader)) return 1;
+    if (header->root_hash != cache->root_hash) return 1;
+
+    uint64_t expected = sizeof(CacheHeader)
+                      + (uint64_t)header->dir_count * sizeof(CacheDirRecord)
+                      + (uint64_t)header->entry_count * sizeof(ListingEntry)
+                      + header->strings_size;
+    if (expected != cache->map_size) return 1;
+
+    const char *body = (const char *)cache->map + sizeof(CacheHeader);
+    if (fnv1a(body, cache->map_size - sizeof(CacheHeader), FNV_OFFSET) != header->checksum) return 1;
+
+    cache->dirs = (const CacheDirRecord *)body;
+    cache->entries = (const ListingEntry *)(cache->dirs + header->dir_count);
+    cache->strings = (const char *)(cache->entries + header->entry_count);
+    cache->dir_count = header->dir_count;
+
+    // Every string must be terminated inside the table
+    if (header->strings_size > 0 && cache->strings[header->strings_size - 1] != '\0') return 1;
+
+    for (uint32_t i = 0; i < header->dir_count; i++) {
+        const CacheDirRecord *rec = &cache->dirs[i];
+        if (rec->path >= header->strings_size) return 1;
+        if ((uint64_t)rec->first_entry + rec->entry_count > header->entry_count) return 1;
+        if (i > 0 && strcmp(cache->strings + cache->dirs[i - 1].path,
+                            cache->strings + rec->path) >= 0) return 1;
+    }
+
+    for (uint32_t i = 0; i < header->entry_count; i++) {
+        if (cache->entries[i].name >= header->strings_size) return 1;
+        if (cache->entries[i].kind != ENTRY_FILE && cache->entries[i].kind != ENTRY_DIR) return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Open cache for a walk rooted at root
+ * Missing, stale or corrupt cache files are ignored (the walk rebuilds them)
+ * Returns FindCache* or NULL on allocation failure
+ */
+FindCache* cache_open(const char *root) {
+    FindCache *cache = calloc(1, sizeof(FindCache));
+    if (cache == NULL) {
+        fprintf(stderr, "Failed to allocate cache\n");
+        return NULL;
+    }
+
+    cache->root_hash = fnv1a(root, strlen(root), FNV_OFFSET);
+    cache->started = time(NULL);
+    snprintf(cache->file, sizeof(cache->file), "%s/find-%016llx.cache",
+             CACHE_DIR, (unsigned long long)cache->root_hash);
+
+    int fd = open(cache->file, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return cache;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        cache->map_size = (size_t)st.st_size;
+        cache->map = mmap(NULL, cache->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (cache->map == MAP_FAILED) {
+            cache->map = NULL;
+        } else if (validate_map(cache) != 0) {
+            // Corrupt or written for another root - rebuild from scratch
+            munmap(cache->map, cache->map_size);
+            cache->map = NULL;
+        }
+    }
+    close(fd);
+
+    if (cache->map == NULL) {
+        cache->dir_count = 0;
+    }
+    return cache;
+}
+
+/**
+ * Start a visited-directory record with the given path and stat data
+ * Returns pointer to the record, or NULL on allocation failure
+ */
+static VisitedDir* add_visited(FindCache *cache, const char *path, const struct stat *st) {
+    size_t path_len = strlen(path) + 1;
+
+    if (reserve((void **)&cache->visited, &cache->visited_cap,
+                cache->visited_count + 1, sizeof(VisitedDir)) != 0 ||
+        reserve((void **)&cache->paths, &cache->paths_cap,
+                cache->paths_len + path_len, 1) != 0) {
+        return NULL;
+    }
+
+    VisitedDir *dir = &cache->visited[cache->visited_count++];
+    memset(dir, 0, sizeof(*dir));
+    dir->path = cache->paths_len;
+    dir->stat.dev = (uint64_t)st->st_dev;
+    dir->stat.ino = (uint64_t)st->st_ino;
+    dir->stat.mtime_sec = (int64_t)st->st_mtim.tv_sec;
+    dir->stat.mtime_nsec = (int64_t)st->st_mtim.tv_nsec;
+    dir->old_index = -1;
+
+    memcpy(cache->paths + cache->paths_len, path, path_len);
+    cache->paths_len += path_len;
+    return dir;
+}
+
+/**
+ * Binary search loaded records by path
+ * Returns record index, or -1 if not found
+ */
+static int64_t find_record(FindCache *cache, const char *path) {
+    int64_t lo = 0;
+    int64_t hi = (int64_t)cache->dir_count - 1;
+
+    while (lo <= hi) {
+        int64_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(cache->strings + cache->dirs[mid].path, path);
+        if (cmp == 0) return mid;
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Look up an unchanged directory
+ * Stats name relative to parent_fd (following symlinks only if follow is set)
+ * On hit, listing borrows its storage from the cache mapping
+ * Returns 0 on hit, 1 on miss
+ */
+int cache_lookup(FindCache *cache, int parent_fd, const char *name, const char *path,
+                 int follow, Listing *listing) {
+    struct stat st;
+
+    if (cache->map == NULL) {
+        return 1;
+    }
+
+    if (fstatat(parent_fd, name, &st, follow ? 0 : AT_SYMLINK_NOFOLLOW) != 0 ||
+        !S_ISDIR(st.st_mode)) {
+        return 1;
+    }
+
+    int64_t index = find_record(cache, path);
+    if (index < 0) {
+        return 1;
+    }
+
+    const CacheDirRecord *rec = &cache->dirs[index];
+    if (rec->dev != (uint64_t)st.st_dev || rec->ino != (uint64_t)st.st_ino ||
+        rec->mtime_sec != (int64_t)st.st_mtim.tv_sec ||
+        rec->mtime_nsec != (int64_t)st.st_mtim.tv_nsec) {
+        return 1;
+    }
+
+    VisitedDir *dir = add_visited(cache, path, &st);
+    if (dir == NULL) {
+        return 1;
+    }
+    dir->old_index = index;
+    dir->stat.flags = rec->flags;
+
+    memset(listing, 0, sizeof(*listing));
+    listing->names = cache->strings;
+    listing->items = cache->entries + rec->first_entry;
+    listing->count = (int)rec->entry_count;
+    listing->flags = rec->flags;
+    return 0;
+}
+
+/**
+ * Remember the listing of a directory that was read from disk
+ * st must be taken before the directory is read
+ */
+void cache_record(FindCache *cache, const char *path, const struct stat *st,
+                  const Listing *listing) {
+    cache->dirty = 1;
+
+    if (st->st_mtim.tv_sec + CACHE_RACY_SECONDS > cache->started) {
+        return;
+    }
+
+    size_t names_needed = cache->names_len;
+    for (int i = 0; i < listing->count; i++) {
+        names_needed += strlen(listing->names + listing->items[i].name) + 1;
+    }
+
+    if (reserve((void **)&cache->new_entries, &cache->new_entry_cap,
+                cache->new_entry_count + listing->count, sizeof(ListingEntry)) != 0 ||
+        reserve((void **)&cache->names, &cache->names_cap, names_needed, 1) != 0) {
+        return;
+    }
+
+    VisitedDir *dir = add_visited(cache, path, st);
+    if (dir == NULL) {
+        return;
+    }
+    dir->first_entry = (uint32_t)cache->new_entry_count;
+    dir->entry_count = (uint32_t)listing->count;
+    dir->stat.flags = listing->flags;
+
+    for (int i = 0; i < listing->count; i++) {
+        const char *name = listing->names + listing->items[i].name;
+        size_t name_len = strlen(name) + 1;
+
+        ListingEntry *entry = &cache->new_entries[cache->new_entry_count++];
+        entry->name = (uint32_t)cache->names_len;
+        entry->kind = listing->items[i].kind;
+
+        memcpy(cache->names + cache->names_len, name, name_len);
+        cache->names_len += name_len;
+    }
+}
+
+/**
+ * Sort key for visited directories
+ */
+typedef struct {
+    const char *path;
+    const VisitedDir *dir;
+} SortedDir;
+
+static int compare_sorted_dirs(const void *a, const void *b) {
+    return strcmp(((const SortedDir *)a)->path, ((const SortedDir *)b)->path);
+}
+
+/**
+ * Write the cache file if anything changed since it was loaded
+ * Returns 0 on success, 1 on error
+ */
+int cache_save(FindCache *cache) {
+    // Every directory matched and none disappeared - file is already current
+    if (!cache->dirty && cache->visited_count == cache->dir_count) {
+        return 0;
+    }
+
+    SortedDir *sorted = malloc((cache->visited_count ? cache->visited_count : 1) * sizeof(SortedDir));
+    if (sorted == NULL) {
+        fprintf(stderr, "Failed to allocate cache\n");
+        return 1;
+    }
+
+    // Size the output: records, entries, then strings (paths and names)
+    uint64_t entry_count = 0;
+    uint64_t strings_size = cache->paths_len;
+    for (size_t i = 0; i < cache->visited_count; i++) {
+        const VisitedDir *dir = &cache->visited[i];
+        sorted[i].path = cache->paths + dir->path;
+        sorted[i].dir = dir;
+
+        if (dir->old_index >= 0) {
+            const CacheDirRecord *rec = &cache->dirs[dir->old_index];
+            entry_count += rec->entry_count;
+            for (uint32_t j = 0; j < rec->entry_count; j++) {
+                strings_size += strlen(cache->strings + cache->entries[rec->first_entry + j].name) + 1;
+            }
+        } else {
+            entry_count += dir->entry_count;
+        }
+    }
+    strings_size += cache->names_len;
+
+    if (entry_count > UINT32_MAX || strings_size > UINT32_MAX) {
+        free(sorted);
+        fprintf(stderr, "Directory tree too large to cache\n");
+        return 1;
+    }
+
+    qsort(sorted, cache->visited_count, sizeof(SortedDir), compare_sorted_dirs);
+
+    size_t total = sizeof(CacheHeader)
+                 + cache->visited_count * sizeof(CacheDirRecord)
+                 + entry_count * sizeof(ListingEntry)
+                 + strings_size;
+    char *out = calloc(1, total);
+    if (out == NULL) {
+        free(sorted);
+        fprintf(stderr, "Failed to allocate cache\n");
+        return 1;
+    }
+
+    CacheHeader *header = (CacheHeader *)out;
+    CacheDirRecord *records = (CacheDirRecord *)(out + sizeof(CacheHeader));
+    ListingEntry *entries = (ListingEntry *)(records + cache->visited_count);
+    char *strings = (char *)(entries + entry_count);
+    uint32_t next_entry = 0;
+    uint64_t next_string = 0;
+
+    for (size_t i = 0; i < cache->visited_count; i++) {
+        const VisitedDir *dir = sorted[i].dir;
+        CacheDirRecord *rec = &records[i];
+
+        *rec = dir->stat;
+        rec->path = next_string;
+        size_t path_len = strlen(sorted[i].path) + 1;
+        memcpy(strings + next_string, sorted[i].path, path_len);
+        next_string += path_len;
+
+        // Entries come from the previous file or from this walk
+        const ListingEntry *src_entries;
+        const char *src_names;
+        uint32_t count;
+        if (dir->old_index >= 0) {
+            const CacheDirRecord *old = &cache->dirs[dir->old_index];
+            src_entries = cache->entries + old->first_entry;
+            src_names = cache->strings;
+            count = old->entry_count;
+        } else {
+            src_entries = cache->new_entries + dir->first_entry;
+            src_names = cache->names;
+            count = dir->entry_count;
+        }
+
+        rec->first_entry = next_entry;
+        rec->entry_count = count;
+        for (uint32_t j = 0; j < count; j++) {
+            const char *name = src_names + src_entries[j].name;
+            size_t name_len = strlen(name) + 1;
+            entries[next_entry].name = (uint32_t)next_string;
+            entries[next_entry].kind = src_entries[j].kind;
+            memcpy(strings + next_string, name, name_len);
+            next_string += name_len;
+            next_entry++;
+        }
+    }
+
+    memcpy(header->magic, CACHE_MAGIC, sizeof(header->magic));
+    header->version = CACHE_VERSION;
+    header->header_size = sizeof(CacheHeader);
+    header->root_hash = cache->root_hash;
+    header->dir_count = (uint32_t)cache->visited_count;
+    header->entry_count = (uint32_t)entry_count;
+    header->strings_size = strings_size;
+    header->checksum = fnv1a(out + sizeof(CacheHeader), total - sizeof(CacheHeader), FNV_OFFSET);
+    free(sorted);
+
+    // Write to a temporary file and rename, so readers never see a partial cache
+    char tmp_file[PATH_MAX + 32];
+    snprintf(tmp_file, sizeof(tmp_file), "%s.%ld.tmp", cache->file, (long)getpid());
+
+    if (mkdir(CACHE_DIR, 0755) == -1 && errno != EEXIST) {
+        fprintf(stderr, "Cannot create %s: %s\n", CACHE_DIR, strerror(errno));
+        free(out);
+        return 1;
+    }
+
+    FILE *fptr = fopen(tmp_file, "wb");
+    if (fptr == NULL) {
+        fprintf(stderr, "Cannot write cache %s: %s\n", tmp_file, strerror(errno));
+        free(out);
+        return 1;
+    }
+
+    int failed = fwrite(out, 1, total, fptr) != total;
+    failed |= fclose(fptr) != 0;
+    free(out);
+
+    if (failed || rename(tmp_file, cache->file) != 0) {
+        fprintf(stderr, "Cannot write cache %s\n", cache->file);
+        unlink(tmp_file);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Unmap cache file and free cache state
+ */
+void cache_close(FindCache *cache) {
+    if (cache == NULL) return;
+
+    if (cache->map != NULL) {
+        munmap(cache->map, cache->map_size);
+    }
+    free(cache->visited);
+    free(cache->paths);
+    free(cache->new_entries);
+    free(cache->names);
+    free(cache);
+}
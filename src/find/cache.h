@@ -0,0 +1,53 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <sys/stat.h>
+#include "walk.h"
+
+#define CACHE_DIR ".jig"
+
+/**
+ * Directory snapshot cache for jig find --cache
+ *
+ * Stored in .jig/find-<hash of root>.cache as one mmap-able file:
+ *   header, directory records sorted by path, listing entries, string table
+ * A directory whose (dev, ino, mtime) still matches its record reuses the
+ * stored listing instead of reading the directory again.
+ */
+typedef struct FindCache FindCache;
+
+/**
+ * Open cache for a walk rooted at root
+ * Missing, stale or corrupt cache files are ignored (the walk rebuilds them)
+ * Returns FindCache* or NULL on allocation failure
+ */
+FindCache* cache_open(const char *root);
+
+/**
+ * Look up an unchanged directory
+ * Stats name relative to parent_fd (following symlinks only if follow is set)
+ * On hit, listing borrows its storage from the cache mapping
+ * Returns 0 on hit, 1 on miss
+ */
+int cache_lookup(FindCache *cache, int parent_fd, const char *name, const char *path,
+                 int follow, Listing *listing);
+
+/**
+ * Remember the listing of a directory that was read from disk
+ * st must be taken before the directory is read
+ */
+void cache_record(FindCache *cache, const char *path, const struct stat *st,
+                  const Listing *listing);
+
+/**
+ * Write the cache file if anything changed since it was loaded
+ * Returns 0 on success, 1 on error
+ */
+int cache_save(FindCache *cache);
+
+/**
+ * Unmap cache file and free cache state
+ */
+void cache_close(FindCache *cache);
+
+#endif /* CACHE_H */
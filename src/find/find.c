@@ -2,14 +2,23 @@
 #include <stdlib.h>
 #include <dirent.h>
 #include <string.h>
-#include <sys/stat.h>
-#include <sys/types.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <limits.h>
 #include <regex.h>
+#include <sys/stat.h>
+#include <time.h>
 #include "find.h"
+#include "walk.h"
+#include "cache.h"
+#include "watch.h"
+#include "ignore.h"
+
+// stdout buffer for non-terminal output: a large listing leaves in few write() calls
+#define OUTPUT_BLOCK_SIZE (1024 * 1024)
 
-#define MAX_DEPTH 100
+static char output_block[OUTPUT_BLOCK_SIZE];
 
 /**
  * Display help information for the 'find' command.
@@ -22,120 +31,345 @@ static void help(void) {
     printf("\n");
     printf("Options:\n");
     printf("  -h, --help             Display this help and exit\n");
-    printf("  -p, --pattern PATTERN  Filter files by regex pattern (filename only)\n");
+    printf("  -p, --pattern PATTERN  Filter files by regex pattern (filename only, repeatable)\n");
+    printf("  -t, --threads N        Walk directories with N worker threads (default: 1)\n");
+    printf("  -0, --null             End each path with NUL instead of newline\n");
+    printf("      --ordered          Keep serial output order when using --threads\n");
+    printf("      --engine ENGINE    Traversal engine: walk (default) or uring\n");
+    printf("      --cache            Reuse listings of unchanged directories from .jig/\n");
+    printf("      --watch            Keep running and print +PATH / -PATH as files change\n");
+    printf("      --ignore           Skip entries matched by .jigignore files\n");
+    printf("      --gitignore        Skip entries matched by .jigignore and .gitignore files\n");
+    printf("      --newer FILE       Only files modified more recently than FILE\n");
+    printf("      --mtime [+-]N      Only files modified more (+), less (-) or exactly N days ago\n");
+    printf("      --size [+-]N[ckMG] Only files larger (+), smaller (-) or exactly N bytes/KiB/MiB/GiB\n");
     printf("\n");
     printf("Examples:\n");
     printf("  jig find ./notes                Find files in specified path\n");
     printf("  jig find                        Find files in current directory\n");
     printf("  jig find -p '\\.md$' ./notes     Find markdown files only\n");
     printf("  jig find -p '^test'             Find files starting with 'test'\n");
+    printf("  jig find -p '\\.md$' -p '\\.txt$'  Find markdown and text files\n");
+    printf("  jig find -t 8 -p '\\.md$' .      Find markdown files using 8 threads\n");
+    printf("  jig find --watch -p '\\.md$' .  List markdown files, then stream changes\n");
+    printf("  jig find --ignore ./site        Skip paths listed in .jigignore files\n");
+    printf("  jig find --newer .jig/stamp .   Files changed since the last build\n");
+    printf("  jig find -0 . | jig filter -0   Paths may contain newlines\n");
 }
 
 /**
- * Recursively process directory and print all file paths.
- * If pattern is provided, only files matching the pattern are printed.
- * Returns 0 on success, 1 on error.
+ * State shared by all levels of the serial walk
+ *
+ * Fields:
+ *   pattern    - Compiled filename patterns (NULL to print every file)
+ *   cache      - Directory snapshot cache (NULL unless --cache)
+ *   watch      - inotify state (NULL unless --watch)
+ *   ignore     - LISTING_HAS_* mask of ignore files to honor
+ *   predicates - --newer / --mtime / --size tests
+ *   terminator - Output record separator
+ *   visit      - Called for each matching file instead of printing it (walk_files())
  */
-static int process_directory(const char *path, int depth, regex_t *pattern) {
+typedef struct {
+    const Matcher *pattern;
+    FindCache *cache;
+    FindWatch *watch;
+    uint32_t ignore;
+    const FilePredicates *predicates;
+    char terminator;
+    WalkVisit visit;
+    void *visit_arg;
+} WalkContext;
+
+/**
+ * One open directory on the walk stack
+ *
+ * Fields:
+ *   dir      - Open handle, NULL for cached listings or after its fd was released
+ *   listing  - Entries of the directory
+ *   next     - Index of the next entry to visit
+ *   path_len - Length of the directory's path in the path buffer
+ *   rules    - Ignore rules for the entries (NULL if none)
+ */
+typedef struct {
     DIR *dir;
-    struct dirent *entry;
-    struct stat statbuf;
-    char fullpath[PATH_MAX];
+    Listing listing;
+    int next;
+    size_t path_len;
+    IgnoreRules *rules;
+} WalkFrame;
+
+/**
+ * Explicit directory stack and the path of the entry being visited
+ * The path buffer grows as needed and is truncated in place when leaving entries
+ */
+typedef struct {
+    WalkFrame *frames;
+    int depth;
+    int capacity;
+    char *path;
     size_t path_len;
-    int has_trailing_slash;
+    size_t path_cap;
+} WalkStack;
+
+/**
+ * Append "/name" to the current path (no slash after a trailing one)
+ * Returns 0 on success, 1 on allocation failure
+ */
+static int push_path(WalkStack *stack, const char *name) {
+    size_t name_len = strlen(name);
+    size_t needed = stack->path_len + name_len + 2;
+
+    if (needed > stack->path_cap) {
+        size_t new_cap = stack->path_cap ? stack->path_cap * 2 : PATH_MAX;
+        while (new_cap < needed) new_cap *= 2;
+        char *tmp = realloc(stack->path, new_cap);
+        if (tmp == NULL) {
+            fprintf(stderr, "Failed to allocate memory for path\n");
+            return 1;
+        }
+        stack->path = tmp;
+        stack->path_cap = new_cap;
+    }
+
+    if (stack->path_len > 0 && stack->path[stack->path_len - 1] != '/') {
+        stack->path[stack->path_len++] = '/';
+    }
+    memcpy(stack->path + stack->path_len, name, name_len + 1);
+    stack->path_len += name_len;
+    return 0;
+}
+
+/**
+ * Cut the current path back to len bytes
+ */
+static void truncate_path(WalkStack *stack, size_t len) {
+    stack->path_len = len;
+    stack->path[len] = '\0';
+}
+
+/**
+ * Close the shallowest directory handle still open on the stack
+ * Its remaining subdirectories are then opened by full path
+ * Returns 1 if a descriptor was released, 0 if none was open
+ */
+static int release_directory_fd(WalkStack *stack) {
+    for (int i = 0; i < stack->depth; i++) {
+        if (stack->frames[i].dir != NULL) {
+            closedir(stack->frames[i].dir);
+            stack->frames[i].dir = NULL;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Read the directory at the current path and push it on the stack.
+ * The directory is name relative to parent_fd (AT_FDCWD for plain paths).
+ * rules are the ignore rules inherited from the parent (reference is consumed).
+ * Returns 0 on success, 1 on error.
+ */
+static int enter_directory(WalkContext *ctx, WalkStack *stack, int parent_fd,
+                           const char *name, IgnoreRules *rules) {
+    const char *path = stack->path;
+    int depth = stack->depth;
+    DIR *dir = NULL;
+    Listing listing;
     int has_error = 0;
 
-    // Prevent infinite recursion
-    if (depth > MAX_DEPTH) {
-        fprintf(stderr, "Maximum directory depth exceeded: %s\n", path);
-        return 1;
+    if (stack->depth == stack->capacity) {
+        int new_capacity = stack->capacity ? stack->capacity * 2 : 64;
+        WalkFrame *tmp = realloc(stack->frames, new_capacity * sizeof(WalkFrame));
+        if (tmp == NULL) {
+            fprintf(stderr, "Failed to allocate memory for directory: %s\n", path);
+            ignore_release(rules);
+            return 1;
+        }
+        stack->frames = tmp;
+        stack->capacity = new_capacity;
     }
 
-    dir = opendir(path);
-    if (dir == NULL) {
-        fprintf(stderr, "Cannot open directory: %s\n", path);
-        return 1;
+    // Watch before reading so changes made during the walk are not lost
+    if (ctx->watch != NULL && watch_add_directory(ctx->watch, path, depth) != 0) {
+        has_error = 1;
     }
 
-    path_len = strlen(path);
-    has_trailing_slash = (path_len > 0 && path[path_len - 1] == '/');
+    // Reuse the cached listing if the directory is unchanged, read it otherwise
+    if (ctx->cache == NULL ||
+        cache_lookup(ctx->cache, parent_fd, name, path, depth == 0, &listing) != 0) {
+        // Refuse symlinks swapped in for subdirectories since the parent was read
+        int flags = depth > 0 ? O_NOFOLLOW : 0;
+        int fd = open_directory(parent_fd, name, flags);
 
-    while ((entry = readdir(dir)) != NULL) {
-        // Skip . and ..
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
+        // Out of descriptors: give up ancestors' handles and open by full path
+        while (fd == -1 && (errno == EMFILE || errno == ENFILE) && release_directory_fd(stack)) {
+            fd = open_directory(AT_FDCWD, path, flags);
         }
 
-        // Skip hidden files
-        if (entry->d_name[0] == '.') {
-            continue;
+        dir = fd == -1 ? NULL : fdopendir(fd);
+        if (dir == NULL) {
+            if (fd != -1) close(fd);
+            fprintf(stderr, "Cannot open directory: %s\n", path);
+            ignore_release(rules);
+            return 1;
         }
 
-        // Build full path, avoiding double slashes
-        int len;
-        if (has_trailing_slash) {
-            len = snprintf(fullpath, PATH_MAX, "%s%s", path, entry->d_name);
-        } else {
-            len = snprintf(fullpath, PATH_MAX, "%s/%s", path, entry->d_name);
+        struct stat st;
+        int have_stat = ctx->cache != NULL && fstat(fd, &st) == 0;
+
+        if (read_listing(dir, path, &listing) != 0) {
+            fprintf(stderr, "Failed to allocate memory for directory: %s\n", path);
+            closedir(dir);
+            ignore_release(rules);
+            return 1;
+        }
+
+        if (have_stat) {
+            cache_record(ctx->cache, path, &st, &listing);
+        }
+    }
+
+    // Add rules from this directory's own ignore files (seen while it was read)
+    if (listing.flags & ctx->ignore) {
+        rules = ignore_load(rules, dir != NULL ? dirfd(dir) : -1, path, listing.flags & ctx->ignore);
+    }
+    if (ctx->watch != NULL) {
+        watch_set_ignore(ctx->watch, depth, rules);
+    }
+
+    WalkFrame *frame = &stack->frames[stack->depth++];
+    frame->dir = dir;
+    frame->listing = listing;
+    frame->next = 0;
+    frame->path_len = stack->path_len;
+    frame->rules = rules;
+    return has_error;
+}
+
+/**
+ * Pop the innermost directory and restore its parent's path
+ */
+static void leave_directory(WalkStack *stack) {
+    WalkFrame *frame = &stack->frames[--stack->depth];
+
+    free_listing(&frame->listing);
+    ignore_release(frame->rules);
+    if (frame->dir != NULL) {
+        closedir(frame->dir);
+    }
+
+    if (stack->depth > 0) {
+        truncate_path(stack, stack->frames[stack->depth - 1].path_len);
+    }
+}
+
+/**
+ * Walk the tree under root depth-first and print all file paths.
+ * Uses a heap-allocated directory stack, so depth is not limited by the C stack.
+ * If patterns are provided, only files matching any of them are printed.
+ * Returns 0 on success, 1 on error.
+ */
+static int walk_tree(WalkContext *ctx, const char *root) {
+    WalkStack stack = {NULL, 0, 0, NULL, 0, 0};
+    int has_error = 0;
+
+    if (push_path(&stack, root) != 0) {
+        return 1;
+    }
+    if (enter_directory(ctx, &stack, AT_FDCWD, root, NULL) != 0) {
+        has_error = 1;
+    }
+
+    while (stack.depth > 0) {
+        WalkFrame *frame = &stack.frames[stack.depth - 1];
+
+        if (frame->next == frame->listing.count) {
+            leave_directory(&stack);
+            continue;
         }
 
-        if (len >= PATH_MAX) {
-            fprintf(stderr, "Path too long: %s/%s\n", path, entry->d_name);
+        const char *entry_name = frame->listing.names + frame->listing.items[frame->next].name;
+        EntryKind kind = frame->listing.items[frame->next].kind;
+        frame->next++;
+
+        // Only extend the path for entries that are printed or descended into
+        if (kind == ENTRY_FILE && !match_filename(entry_name, ctx->pattern)) {
             continue;
         }
 
-        // Use lstat to detect symlinks and avoid following them
-        if (lstat(fullpath, &statbuf) == -1) {
-            fprintf(stderr, "Cannot stat %s: %s\n", fullpath, strerror(errno));
+        // Ignored directories are pruned without being opened
+        if (ignore_match(frame->rules, entry_name, kind == ENTRY_DIR)) {
             continue;
         }
 
-        // Skip symbolic links to prevent loops
-        if (S_ISLNK(statbuf.st_mode)) {
+        if (push_path(&stack, entry_name) != 0) {
+            has_error = 1;
             continue;
         }
 
-        if (S_ISDIR(statbuf.st_mode)) {
-            // Recursively process subdirectory
-            if (process_directory(fullpath, depth + 1, pattern) != 0) {
-                has_error = 1;
-                // Continue processing other entries despite error
-            }
-        } else {
-            // Extract filename from full path
-            const char *filename = strrchr(fullpath, '/');
-            if (filename != NULL) {
-                filename++; // Skip the '/' character
-            } else {
-                filename = fullpath; // No '/' found, use entire path
+        if (kind == ENTRY_FILE) {
+            // Stat only when a metadata predicate is active; cached listings have no dirfd
+            if (ctx->predicates->flags == 0 ||
+                match_predicates(ctx->predicates, frame->dir != NULL ? dirfd(frame->dir) : AT_FDCWD,
+                                 frame->dir != NULL ? entry_name : stack.path)) {
+                if (ctx->visit != NULL) {
+                    ctx->visit(stack.path, ctx->visit_arg);
+                } else {
+                    print_path(stack.path, ctx->terminator);
+                }
+                if (ctx->watch != NULL) {
+                    watch_add_file(ctx->watch, stack.depth - 1, entry_name);
+                }
             }
+            truncate_path(&stack, frame->path_len);
+            continue;
+        }
 
-            // Check if filename matches pattern (if provided)
-            int matches = 1; // Default to match if no pattern
-            if (pattern != NULL) {
-                int rgx_result = regexec(pattern, filename, 0, NULL, 0);
-                matches = (rgx_result == 0);
-            }
+        // Open subdirectories relative to this one when it was read from disk
+        int child_parent = frame->dir != NULL ? dirfd(frame->dir) : AT_FDCWD;
+        const char *child_name = frame->dir != NULL ? entry_name : stack.path;
+        IgnoreRules *child_rules = ignore_descend(frame->rules, entry_name);
 
-            // Print the file path if it matches
-            if (matches) {
-                printf("%s\n", fullpath);
-            }
+        // frame may move when the stack grows; on failure the path is cut back here
+        size_t parent_len = frame->path_len;
+        int depth = stack.depth;
+        if (enter_directory(ctx, &stack, child_parent, child_name, child_rules) != 0) {
+            has_error = 1;
+            // Continue processing other entries despite error
+        }
+        if (stack.depth == depth) {
+            truncate_path(&stack, parent_len);
         }
     }
 
-    closedir(dir);
+    free(stack.frames);
+    free(stack.path);
     return has_error;
 }
 
+/**
+ * Walk the tree under root serially and call visit for each file matching
+ * pattern (NULL for every file), in the order jig find prints them
+ * Returns 0 on success, 1 on error
+ */
+int walk_files(const char *root, const Matcher *pattern, WalkVisit visit, void *arg) {
+    FilePredicates predicates = {0};
+    WalkContext ctx = {pattern, NULL, NULL, 0, &predicates, '\n', visit, arg};
+    return walk_tree(&ctx, root);
+}
+
 int find(int argc, char **argv) {
-    char *pattern_str = NULL;
+    FindOptions opts = {NULL, 0, 1, 0, ENGINE_WALK, 0, 0, 0, {0}, '\n'};
+    const char *engine_str = NULL;
     char *path = NULL;
-    regex_t rgx_pattern;
-    regex_t *pattern_ptr = NULL;
-    int rgx_result;
+    Matcher matcher;
+    Matcher *pattern_ptr = NULL;
     int exit_status;
 
+    // Every -p argument is kept; a file is printed if any of them matches
+    const char *patterns[argc];
+    opts.patterns = patterns;
+
     // Parse arguments
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
@@ -144,12 +378,69 @@ int find(int argc, char **argv) {
         } else if (strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--pattern") == 0) {
             // Next argument should be the pattern
             if (i + 1 < argc) {
-                pattern_str = argv[i + 1];
+                opts.patterns[opts.pattern_count++] = argv[i + 1];
                 i++; // Skip next argument
             } else {
                 fprintf(stderr, "Error: -p/--pattern requires a pattern argument\n");
                 return 1;
             }
+        } else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threads") == 0) {
+            // Next argument should be the thread count
+            if (i + 1 < argc) {
+                char *end;
+                long threads = strtol(argv[i + 1], &end, 10);
+                if (*end != '\0' || threads < 1 || threads > MAX_THREADS) {
+                    fprintf(stderr, "Error: -t/--threads must be between 1 and %d\n", MAX_THREADS);
+                    return 1;
+                }
+                opts.threads = (int)threads;
+                i++; // Skip next argument
+            } else {
+                fprintf(stderr, "Error: -t/--threads requires a number argument\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-0") == 0 || strcmp(argv[i], "--null") == 0) {
+            opts.terminator = '\0';
+        } else if (strcmp(argv[i], "--ordered") == 0) {
+            opts.ordered = 1;
+        } else if (strcmp(argv[i], "--cache") == 0) {
+            opts.cache = 1;
+        } else if (strcmp(argv[i], "--watch") == 0) {
+            opts.watch = 1;
+        } else if (strcmp(argv[i], "--ignore") == 0) {
+            opts.ignore |= LISTING_HAS_JIGIGNORE;
+        } else if (strcmp(argv[i], "--gitignore") == 0) {
+            opts.ignore |= LISTING_HAS_JIGIGNORE | LISTING_HAS_GITIGNORE;
+        } else if (strcmp(argv[i], "--newer") == 0 || strcmp(argv[i], "--mtime") == 0 ||
+                   strcmp(argv[i], "--size") == 0) {
+            // Next argument is the predicate value
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: %s requires an argument\n", argv[i]);
+                return 1;
+            }
+            int result;
+            if (strcmp(argv[i], "--newer") == 0) {
+                result = parse_newer_predicate(argv[i + 1], &opts.predicates);
+            } else if (strcmp(argv[i], "--mtime") == 0) {
+                result = parse_mtime_predicate(argv[i + 1], &opts.predicates);
+            } else {
+                result = parse_size_predicate(argv[i + 1], &opts.predicates);
+            }
+            if (result != 0) {
+                return 1;
+            }
+            i++; // Skip next argument
+        } else if (strncmp(argv[i], "--engine=", 9) == 0) {
+            engine_str = argv[i] + 9;
+        } else if (strcmp(argv[i], "--engine") == 0) {
+            // Next argument should be the engine name
+            if (i + 1 < argc) {
+                engine_str = argv[i + 1];
+                i++; // Skip next argument
+            } else {
+                fprintf(stderr, "Error: --engine requires an engine name\n");
+                return 1;
+            }
         } else if (argv[i][0] != '-') {
             // Non-option argument is the path
             path = argv[i];
@@ -160,29 +451,104 @@ int find(int argc, char **argv) {
         }
     }
 
-    // Compile regex pattern if provided
-    if (pattern_str != NULL) {
-        rgx_result = regcomp(&rgx_pattern, pattern_str, REG_EXTENDED | REG_ICASE | REG_NEWLINE);
-        if (rgx_result != 0) {
-            char error_message[100];
-            regerror(rgx_result, &rgx_pattern, error_message, sizeof(error_message));
-            fprintf(stderr, "Could not compile regex pattern: %s\n", error_message);
+    // Resolve traversal engine
+    if (engine_str != NULL) {
+        if (strcmp(engine_str, "walk") == 0) {
+            opts.engine = ENGINE_WALK;
+        } else if (strcmp(engine_str, "uring") == 0) {
+            opts.engine = ENGINE_URING;
+        } else {
+            fprintf(stderr, "Error: Unknown engine: %s (expected walk or uring)\n", engine_str);
             return 1;
         }
-        pattern_ptr = &rgx_pattern;
     }
 
+    if (opts.engine == ENGINE_URING && (opts.threads > 1 || opts.ordered)) {
+        fprintf(stderr, "Error: --engine uring cannot be combined with --threads or --ordered\n");
+        return 1;
+    }
+
+    if (opts.cache && (opts.threads > 1 || opts.engine == ENGINE_URING)) {
+        fprintf(stderr, "Error: --cache cannot be combined with --threads or --engine uring\n");
+        return 1;
+    }
+
+    if (opts.watch && (opts.threads > 1 || opts.engine == ENGINE_URING)) {
+        fprintf(stderr, "Error: --watch cannot be combined with --threads or --engine uring\n");
+        return 1;
+    }
+
+    if (opts.ignore && (opts.threads > 1 || opts.engine == ENGINE_URING)) {
+        fprintf(stderr, "Error: --ignore/--gitignore cannot be combined with --threads or --engine uring\n");
+        return 1;
+    }
+
+    if (opts.predicates.flags != 0 && (opts.engine == ENGINE_URING || opts.watch)) {
+        fprintf(stderr, "Error: --newer/--mtime/--size cannot be combined with --engine uring or --watch\n");
+        return 1;
+    }
+    opts.predicates.now = time(NULL);
+
     // Use current directory if no path specified
     if (path == NULL) {
         path = ".";
     }
 
+    // Block-buffer pipes and files; terminals keep the default line buffering
+    if (!isatty(STDOUT_FILENO)) {
+        setvbuf(stdout, output_block, _IOFBF, sizeof(output_block));
+    }
+
+    // Parallel walk compiles the pattern once per worker
+    if (opts.threads > 1) {
+        return walk_parallel(path, &opts);
+    }
+
+    // Compile patterns if provided
+    if (opts.pattern_count > 0) {
+        if (compile_matcher(opts.patterns, opts.pattern_count, &matcher) != 0) {
+            return 1;
+        }
+        pattern_ptr = &matcher;
+    }
+
+    // io_uring engine, falling back to the regular walk when the kernel lacks support
+    if (opts.engine == ENGINE_URING) {
+        exit_status = walk_uring(path, pattern_ptr, opts.terminator);
+        if (exit_status != WALK_UNSUPPORTED) {
+            if (pattern_ptr != NULL) {
+                free_matcher(&matcher);
+            }
+            return exit_status;
+        }
+    }
+
     // Process directory
-    exit_status = process_directory(path, 0, pattern_ptr);
+    WalkContext ctx = {pattern_ptr, NULL, NULL, opts.ignore, &opts.predicates, opts.terminator, NULL, NULL};
+    if ((opts.cache && (ctx.cache = cache_open(path)) == NULL) ||
+        (opts.watch && (ctx.watch = watch_open(pattern_ptr, opts.ignore, opts.terminator)) == NULL)) {
+        exit_status = 1;
+    } else {
+        exit_status = walk_tree(&ctx, path);
+    }
+
+    // Store listings for the next run (a failed write does not fail the walk)
+    if (ctx.cache != NULL) {
+        cache_save(ctx.cache);
+        cache_close(ctx.cache);
+    }
+
+    // Stream changes until the root goes away
+    if (ctx.watch != NULL) {
+        if (watch_run(ctx.watch) != 0) {
+            exit_status = 1;
+        }
+        watch_close(ctx.watch);
+    }
 
-    // Free compiled regex pattern if it was used
+    // Free compiled patterns if they were used
     if (pattern_ptr != NULL) {
-        regfree(&rgx_pattern);
+        free_matcher(&matcher);
     }
 
     return exit_status;
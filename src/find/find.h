@@ -6,9 +6,9 @@
  * Usage:
  *   jig find <directory> [-p|--pattern <regex>]
  *
- * Recursively traverses directory structure (max 100 levels)
+ * Recursively traverses directory structure (no depth limit)
  * Skips hidden files (starting with .) and symbolic links
- * Optional regex pattern filtering with -p/--pattern flag
+ * Optional regex pattern filtering with -p/--pattern flag (repeatable)
  * Outputs full file paths (one per line) to stdout
  *
  * Returns 0 on success, non-zero on error
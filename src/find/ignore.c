@@ -0,0 +1,367 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <limits.h>
+#include <unistd.h>
+#include "walk.h"
+#include "ignore.h"
+
+/**
+ * One "/"-separated part of a rule
+ *
+ * Fields:
+ *   text     - Glob for a single name
+ *   literal  - text has no glob characters (compared with strcmp)
+ *   globstar - text is "**" (any number of directories)
+ */
+typedef struct {
+    char *text;
+    int literal;
+    int globstar;
+} IgnoreSegment;
+
+/**
+ * One line of an ignore file
+ *
+ * Fields:
+ *   segments - Path parts relative to the directory holding the ignore file
+ *   anchored - Rule contains "/" and only matches at that exact position;
+ *              otherwise it is a single name matched at any depth
+ *   negate   - "!" rule that re-includes an entry
+ *   dir_only - Trailing "/": only matches directories
+ */
+typedef struct {
+    IgnoreSegment *segments;
+    int segment_count;
+    int anchored;
+    int negate;
+    int dir_only;
+} IgnoreRule;
+
+/**
+ * Rule as seen from one directory: segment is the part that must match a direct child
+ */
+typedef struct {
+    const IgnoreRule *rule;
+    int segment;
+} ActiveRule;
+
+struct IgnoreRules {
+    int refs;
+    IgnoreRules *parent;      // Keeps rules loaded by ancestors alive
+    IgnoreRule *owned;        // Rules loaded from this directory's files
+    int owned_count;
+    ActiveRule *active;       // In file order, later rules win
+    int active_count;
+};
+
+static int segment_matches(const IgnoreSegment *segment, const char *name) {
+    if (segment->globstar) return 1;
+    if (segment->literal) return strcmp(segment->text, name) == 0;
+    return fnmatch(segment->text, name, 0) == 0;
+}
+
+static void free_rule(IgnoreRule *rule) {
+    for (int i = 0; i < rule->segment_count; i++) {
+        free(rule->segments[i].text);
+    }
+    free(rule->segments);
+}
+
+/**
+ * Parse one line of an ignore file (modified in place)
+ * Returns 0 if a rule was produced, 1 for blank lines, comments and errors
+ */
+static int parse_rule(char *line, IgnoreRule *rule) {
+    size_t len = strlen(line);
+
+    memset(rule, 0, sizeof(*rule));
+
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+        line[--len] = '\0';
+    }
+    // Trailing spaces are ignored unless escaped
+    while (len > 0 && line[len - 1] == ' ' && !(len > 1 && line[len - 2] == '\\')) {
+        line[--len] = '\0';
+    }
+    if (len == 0 || line[0] == '#') {
+        return 1;
+    }
+
+    if (line[0] == '!') {
+        rule->negate = 1;
+        line++;
+        len--;
+    }
+    while (len > 0 && line[len - 1] == '/') {
+        rule->dir_only = 1;
+        line[--len] = '\0';
+    }
+    if (len == 0) {
+        return 1;
+    }
+
+    rule->anchored = strchr(line, '/') != NULL;
+
+    rule->segments = calloc(len, sizeof(IgnoreSegment));
+    if (rule->segments == NULL) {
+        return 1;
+    }
+
+    char *saveptr;
+    for (char *part = strtok_r(line, "/", &saveptr); part != NULL;
+         part = strtok_r(NULL, "/", &saveptr)) {
+        IgnoreSegment *segment = &rule->segments[rule->segment_count];
+        segment->text = strdup(part);
+        if (segment->text == NULL) {
+            free_rule(rule);
+            return 1;
+        }
+        segment->globstar = strcmp(part, "**") == 0;
+        segment->literal = strpbrk(part, "*?[\\") == NULL;
+        rule->segment_count++;
+    }
+
+    if (rule->segment_count == 0) {
+        free_rule(rule);
+        return 1;
+    }
+
+    // "**/name" is the same as a plain "name"
+    if (rule->anchored && rule->segment_count == 2 &&
+        rule->segments[0].globstar && !rule->segments[1].globstar) {
+        free(rule->segments[0].text);
+        rule->segments[0] = rule->segments[1];
+        rule->segment_count = 1;
+        rule->anchored = 0;
+    }
+    return 0;
+}
+
+/**
+ * Append the rules of one ignore file to owned
+ */
+static void read_rules(int dirfd, const char *path, const char *filename,
+                       IgnoreRule **owned, int *count, int *cap) {
+    char filepath[PATH_MAX];
+    int fd;
+
+    if (dirfd >= 0) {
+        fd = openat(dirfd, filename, O_RDONLY | O_CLOEXEC);
+    } else if (join_path(filepath, sizeof(filepath), path, filename) >= 0) {
+        fd = open(filepath, O_RDONLY | O_CLOEXEC);
+    } else {
+        fd = -1;
+        errno = ENAMETOOLONG;
+    }
+
+    FILE *file = fd == -1 ? NULL : fdopen(fd, "r");
+    if (file == NULL) {
+        if (fd != -1) close(fd);
+        // Removed since the directory was listed: nothing to apply
+        if (errno != ENOENT) {
+            fprintf(stderr, "Cannot read %s/%s: %s\n", path, filename, strerror(errno));
+        }
+        return;
+    }
+
+    char *line = NULL;
+    size_t line_cap = 0;
+    while (getline(&line, &line_cap, file) != -1) {
+        if (*count == *cap) {
+            int new_cap = *cap ? *cap * 2 : 16;
+            IgnoreRule *tmp = realloc(*owned, new_cap * sizeof(IgnoreRule));
+            if (tmp == NULL) {
+                fprintf(stderr, "Failed to allocate memory for ignore rules\n");
+                break;
+            }
+            *owned = tmp;
+            *cap = new_cap;
+        }
+        if (parse_rule(line, &(*owned)[*count]) == 0) {
+            (*count)++;
+        }
+    }
+
+    free(line);
+    fclose(file);
+}
+
+/**
+ * Append the rules from the ignore files present in a directory
+ * Takes over the inherited reference and returns the combined rules (or NULL)
+ */
+IgnoreRules* ignore_load(IgnoreRules *inherited, int dirfd, const char *path, uint32_t files) {
+    IgnoreRule *owned = NULL;
+    int owned_count = 0;
+    int owned_cap = 0;
+
+    // .jigignore comes last so its rules take precedence over .gitignore
+    if (files & LISTING_HAS_GITIGNORE) {
+        read_rules(dirfd, path, GITIGNORE_FILE, &owned, &owned_count, &owned_cap);
+    }
+    if (files & LISTING_HAS_JIGIGNORE) {
+        read_rules(dirfd, path, JIGIGNORE_FILE, &owned, &owned_count, &owned_cap);
+    }
+
+    if (owned_count == 0) {
+        free(owned);
+        return inherited;
+    }
+
+    int inherited_count = inherited ? inherited->active_count : 0;
+    IgnoreRules *rules = calloc(1, sizeof(IgnoreRules));
+    ActiveRule *active = malloc((inherited_count + owned_count) * sizeof(ActiveRule));
+    if (rules == NULL || active == NULL) {
+        fprintf(stderr, "Failed to allocate memory for ignore rules\n");
+        for (int i = 0; i < owned_count; i++) free_rule(&owned[i]);
+        free(owned);
+        free(active);
+        free(rules);
+        return inherited;
+    }
+
+    if (inherited_count > 0) {
+        memcpy(active, inherited->active, inherited_count * sizeof(ActiveRule));
+    }
+    for (int i = 0; i < owned_count; i++) {
+        active[inherited_count + i].rule = &owned[i];
+        active[inherited_count + i].segment = 0;
+    }
+
+    rules->refs = 1;
+    rules->parent = inherited;
+    rules->owned = owned;
+    rules->owned_count = owned_count;
+    rules->active = active;
+    rules->active_count = inherited_count + owned_count;
+    return rules;
+}
+
+/**
+ * Rules for the entries of subdirectory name, before its own ignore files
+ * Returns a new reference (may be rules itself) or NULL if no rule applies
+ */
+IgnoreRules* ignore_descend(IgnoreRules *rules, const char *name) {
+    if (rules == NULL) {
+        return NULL;
+    }
+
+    // A "**" rule can stay in place and also advance past its next part
+    ActiveRule *active = malloc(2 * rules->active_count * sizeof(ActiveRule));
+    if (active == NULL) {
+        return ignore_retain(rules);
+    }
+
+    int count = 0;
+    int changed = 0;
+    for (int i = 0; i < rules->active_count; i++) {
+        ActiveRule current = rules->active[i];
+        const IgnoreRule *rule = current.rule;
+        int remaining = rule->segment_count - current.segment;
+        const IgnoreSegment *segment = &rule->segments[current.segment];
+
+        if (!rule->anchored) {
+            active[count++] = current;
+        } else if (segment->globstar) {
+            active[count++] = current;
+            if (remaining >= 3 && segment_matches(segment + 1, name)) {
+                active[count].rule = rule;
+                active[count].segment = current.segment + 2;
+                count++;
+                changed = 1;
+            }
+        } else {
+            // Anchored rule either follows this directory or no longer applies
+            changed = 1;
+            if (remaining >= 2 && segment_matches(segment, name)) {
+                active[count].rule = rule;
+                active[count].segment = current.segment + 1;
+                count++;
+            }
+        }
+    }
+
+    if (!changed) {
+        free(active);
+        return ignore_retain(rules);
+    }
+    if (count == 0) {
+        free(active);
+        return NULL;
+    }
+
+    IgnoreRules *child = calloc(1, sizeof(IgnoreRules));
+    if (child == NULL) {
+        free(active);
+        return ignore_retain(rules);
+    }
+    child->refs = 1;
+    child->parent = ignore_retain(rules);
+    child->active = active;
+    child->active_count = count;
+    return child;
+}
+
+/**
+ * Check whether an entry of the directory is ignored
+ * Returns 1 if ignored, 0 otherwise (including rules == NULL)
+ */
+int ignore_match(const IgnoreRules *rules, const char *name, int is_dir) {
+    if (rules == NULL) {
+        return 0;
+    }
+
+    // The last matching rule decides
+    for (int i = rules->active_count - 1; i >= 0; i--) {
+        const IgnoreRule *rule = rules->active[i].rule;
+        const IgnoreSegment *segment = &rule->segments[rules->active[i].segment];
+        int remaining = rule->segment_count - rules->active[i].segment;
+
+        if (rule->dir_only && !is_dir) {
+            continue;
+        }
+
+        int matched;
+        if (remaining == 1) {
+            matched = segment_matches(segment, name);
+        } else {
+            // "**/last" also matches with "**" standing for no directory at all
+            matched = remaining == 2 && segment->globstar && segment_matches(segment + 1, name);
+        }
+
+        if (matched) {
+            return !rule->negate;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Take an extra reference
+ */
+IgnoreRules* ignore_retain(IgnoreRules *rules) {
+    if (rules != NULL) {
+        rules->refs++;
+    }
+    return rules;
+}
+
+/**
+ * Drop a reference (NULL is allowed)
+ */
+void ignore_release(IgnoreRules *rules) {
+    while (rules != NULL && --rules->refs == 0) {
+        IgnoreRules *parent = rules->parent;
+        for (int i = 0; i < rules->owned_count; i++) {
+            free_rule(&rules->owned[i]);
+        }
+        free(rules->owned);
+        free(rules->active);
+        free(rules);
+        rules = parent;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef IGNORE_H
+#define IGNORE_H
+
+#include <stdint.h>
+
+#define JIGIGNORE_FILE ".jigignore"
+#define GITIGNORE_FILE ".gitignore"
+
+/**
+ * Ignore rules in effect for the entries of one directory (jig find --ignore)
+ *
+ * Rules use .gitignore syntax. They are read once per directory and turned
+ * into a flat list of "what a direct child must look like to be ignored";
+ * a subdirectory derives its own list from its parent's when the walk
+ * descends, so matching an entry never re-walks its path.
+ * Reference counted: sibling directories share one set when no rule changes.
+ */
+typedef struct IgnoreRules IgnoreRules;
+
+/**
+ * Rules for the entries of subdirectory name, before its own ignore files
+ * Returns a new reference (may be rules itself) or NULL if no rule applies
+ */
+IgnoreRules* ignore_descend(IgnoreRules *rules, const char *name);
+
+/**
+ * Append rules from the ignore files present in a directory
+ * files is a mask of LISTING_HAS_JIGIGNORE / LISTING_HAS_GITIGNORE
+ * Files are opened relative to dirfd, or by path when dirfd is -1
+ * Takes over the inherited reference and returns the combined rules (or NULL)
+ */
+IgnoreRules* ignore_load(IgnoreRules *inherited, int dirfd, const char *path, uint32_t files);
+
+/**
+ * Check whether an entry of the directory is ignored
+ * Returns 1 if ignored, 0 otherwise (including rules == NULL)
+ */
+int ignore_match(const IgnoreRules *rules, const char *name, int is_dir);
+
+/**
+ * Take an extra reference
+ */
+IgnoreRules* ignore_retain(IgnoreRules *rules);
+
+/**
+ * Drop a reference (NULL is allowed)
+ */
+void ignore_release(IgnoreRules *rules);
+
+#endif /* IGNORE_H */
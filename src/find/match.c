@@ -0,0 +1,261 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <regex.h>
+#include "walk.h"
+
+#define REGEX_FLAGS (REG_EXTENDED | REG_ICASE | REG_NEWLINE | REG_NOSUB)
+
+/**
+ * Report a regcomp() failure for pattern_str
+ */
+static void report_regex_error(int result, regex_t *rgx, const char *pattern_str) {
+    char error_message[100];
+    regerror(result, rgx, error_message, sizeof(error_message));
+    fprintf(stderr, "Could not compile regex pattern '%s': %s\n", pattern_str, error_message);
+}
+
+/**
+ * Check whether c has a special meaning in an extended regex
+ */
+static int is_regex_special(char c) {
+    return strchr(".[]()*+?{}|^$\\", c) != NULL;
+}
+
+/**
+ * Try to reduce pattern_str to a literal with optional ^ and $ anchors
+ * Escaped punctuation (e.g. "\.") counts as a literal character
+ * Returns 0 and fills literal on success, 1 if pattern_str needs regexec()
+ */
+static int parse_literal(const char *pattern_str, LiteralPattern *literal) {
+    size_t len = strlen(pattern_str);
+    int anchored_start = 0;
+    int anchored_end = 0;
+    const char *p = pattern_str;
+    const char *end = pattern_str + len;
+
+    if (p < end && *p == '^') {
+        anchored_start = 1;
+        p++;
+    }
+    // A trailing "$" is an anchor unless it is escaped
+    if (end > p && end[-1] == '$' && !(end - 1 > p && end[-2] == '\\')) {
+        anchored_end = 1;
+        end--;
+    }
+
+    char *text = malloc((end - p) + 1);
+    if (text == NULL) return 1;
+
+    size_t text_len = 0;
+    int has_alpha = 0;
+    while (p < end) {
+        char c = *p++;
+        if (c == '\\') {
+            // Only escaped punctuation is a plain character; "\w", "\<" etc. are regex syntax
+            if (p == end || !is_regex_special(*p)) {
+                free(text);
+                return 1;
+            }
+            c = *p++;
+        } else if (is_regex_special(c)) {
+            free(text);
+            return 1;
+        }
+        // Patterns are case-insensitive: store the literal folded to lowercase (C locale)
+        if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        if (c >= 'a' && c <= 'z') has_alpha = 1;
+        text[text_len++] = c;
+    }
+    text[text_len] = '\0';
+
+    if (anchored_start && anchored_end) {
+        literal->kind = LITERAL_EXACT;
+    } else if (anchored_start) {
+        literal->kind = LITERAL_PREFIX;
+    } else if (anchored_end) {
+        literal->kind = LITERAL_SUFFIX;
+    } else {
+        literal->kind = LITERAL_SUBSTRING;
+    }
+    literal->text = text;
+    literal->len = text_len;
+    literal->fold = has_alpha;
+    return 0;
+}
+
+/**
+ * Compare n bytes of s with lowercase literal, ignoring ASCII case
+ */
+static int equal_folded(const char *s, const char *literal, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        char c = s[i];
+        if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        if (c != literal[i]) return 0;
+    }
+    return 1;
+}
+
+/**
+ * Match one literal against filename of length len
+ */
+static int match_literal(const LiteralPattern *literal, const char *filename, size_t len) {
+    if (literal->len > len) {
+        return 0;
+    }
+
+    switch (literal->kind) {
+    case LITERAL_EXACT:
+        if (literal->len != len) return 0;
+        /* fall through */
+    case LITERAL_PREFIX:
+        return literal->fold ? equal_folded(filename, literal->text, literal->len)
+                             : memcmp(filename, literal->text, literal->len) == 0;
+    case LITERAL_SUFFIX:
+        filename += len - literal->len;
+        return literal->fold ? equal_folded(filename, literal->text, literal->len)
+                             : memcmp(filename, literal->text, literal->len) == 0;
+    case LITERAL_SUBSTRING:
+        if (!literal->fold) {
+            return memmem(filename, len, literal->text, literal->len) != NULL;
+        }
+        if (len <= NAME_MAX) {
+            // Fold the name once, then search it with memmem()
+            char folded[NAME_MAX + 1];
+            for (size_t i = 0; i < len; i++) {
+                char c = filename[i];
+                folded[i] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+            }
+            return memmem(folded, len, literal->text, literal->len) != NULL;
+        }
+        return strcasestr(filename, literal->text) != NULL;
+    }
+    return 0;
+}
+
+/**
+ * Compile one or more filename patterns (extended, case-insensitive regexes)
+ *
+ * Patterns that are plain literals with optional ^/$ anchors become
+ * prefix/suffix/substring/exact matchers; the rest are joined into a single
+ * "(p1)|(p2)|..." regex so a filename is scanned by regexec() only once.
+ * Patterns with back-references cannot be joined (group numbers would shift)
+ * and are compiled separately.
+ *
+ * Prints an error message to stderr on failure
+ * Returns 0 on success, 1 on error
+ */
+int compile_matcher(const char *const *patterns, int count, Matcher *matcher) {
+    int *is_regex = calloc(count ? count : 1, sizeof(int));
+    memset(matcher, 0, sizeof(Matcher));
+    matcher->literals = calloc(count ? count : 1, sizeof(LiteralPattern));
+    matcher->regexes = calloc(count ? count : 1, sizeof(regex_t));
+    if (is_regex == NULL || matcher->literals == NULL || matcher->regexes == NULL) {
+        fprintf(stderr, "Failed to allocate memory for pattern\n");
+        free(is_regex);
+        free_matcher(matcher);
+        return 1;
+    }
+
+    size_t joined_size = 1;
+    int joinable = 1;
+    int regex_patterns = 0;
+
+    // Validate every pattern on its own so errors name the offending one
+    for (int i = 0; i < count; i++) {
+        regex_t rgx;
+        int result = regcomp(&rgx, patterns[i], REGEX_FLAGS);
+        if (result != 0) {
+            report_regex_error(result, &rgx, patterns[i]);
+            free(is_regex);
+            free_matcher(matcher);
+            return 1;
+        }
+
+        if (parse_literal(patterns[i], &matcher->literals[matcher->literal_count]) == 0) {
+            matcher->literal_count++;
+            regfree(&rgx);
+            continue;
+        }
+
+        is_regex[i] = 1;
+        regex_patterns++;
+        joined_size += strlen(patterns[i]) + 3;
+        for (const char *p = patterns[i]; *p; p++) {
+            if (p[0] == '\\' && p[1] >= '1' && p[1] <= '9') joinable = 0;
+            if (p[0] == '\\' && p[1] != '\0') p++;
+        }
+
+        // Keep the individual regex in case the patterns cannot be joined
+        matcher->regexes[matcher->regex_count++] = rgx;
+    }
+
+    if (regex_patterns > 1 && joinable) {
+        char *joined = malloc(joined_size);
+        regex_t combined;
+
+        if (joined != NULL) {
+            size_t len = 0;
+            for (int i = 0; i < count; i++) {
+                if (!is_regex[i]) continue;
+                len += sprintf(joined + len, "%s(%s)", len ? "|" : "", patterns[i]);
+            }
+
+            // Fall back to separate regexes if the alternation does not compile
+            if (regcomp(&combined, joined, REGEX_FLAGS) == 0) {
+                for (int i = 0; i < matcher->regex_count; i++) {
+                    regfree(&matcher->regexes[i]);
+                }
+                matcher->regexes[0] = combined;
+                matcher->regex_count = 1;
+            }
+            free(joined);
+        }
+    }
+
+    free(is_regex);
+    return 0;
+}
+
+/**
+ * Check filename against an optional matcher
+ * Returns 1 if any pattern matches or matcher is NULL, 0 otherwise
+ */
+int match_filename(const char *filename, const Matcher *matcher) {
+    if (matcher == NULL) {
+        return 1;
+    }
+
+    if (matcher->literal_count > 0) {
+        size_t len = strlen(filename);
+        for (int i = 0; i < matcher->literal_count; i++) {
+            if (match_literal(&matcher->literals[i], filename, len)) {
+                return 1;
+            }
+        }
+    }
+
+    for (int i = 0; i < matcher->regex_count; i++) {
+        if (regexec(&matcher->regexes[i], filename, 0, NULL, 0) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Free compiled patterns
+ */
+void free_matcher(Matcher *matcher) {
+    for (int i = 0; i < matcher->literal_count; i++) {
+        free(matcher->literals[i].text);
+    }
+    for (int i = 0; i < matcher->regex_count; i++) {
+        regfree(&matcher->regexes[i]);
+    }
+    free(matcher->literals);
+    free(matcher->regexes);
+    memset(matcher, 0, sizeof(Matcher));
+}
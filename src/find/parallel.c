@@ -0,0 +1,507 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <regex.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "walk.h"
+
+#define DEQUE_INITIAL_CAPACITY 64
+#define OUTPUT_BUFFER_SIZE 65536
+
+typedef struct WalkDir WalkDir;
+
+/**
+ * One entry of a directory result in ordered mode
+ * Exactly one of path (file) or child (subdirectory) is set
+ */
+typedef struct {
+    char *path;
+    WalkDir *child;
+} WalkEntry;
+
+/**
+ * Ordered-mode result of one directory, in readdir order
+ * Emitted depth-first after all workers finish
+ */
+struct WalkDir {
+    WalkEntry *items;
+    int count;
+    int capacity;
+};
+
+/**
+ * Unit of work: one directory to list
+ */
+typedef struct {
+    char *path;
+    int depth;
+    WalkDir *result;  // Ordered mode only, NULL otherwise
+} DirJob;
+
+/**
+ * Per-worker double-ended job queue
+ * Owner pushes and pops at the tail (depth-first), thieves take from the head
+ */
+typedef struct {
+    DirJob **items;
+    int head;
+    int tail;
+    int capacity;
+    pthread_mutex_t lock;
+} JobDeque;
+
+typedef struct Walker Walker;
+
+typedef struct {
+    Walker *walker;
+    int index;
+    JobDeque deque;
+    Matcher matcher;
+    Matcher *pattern;
+    char output[OUTPUT_BUFFER_SIZE];
+    size_t output_len;
+    pthread_t thread;
+} Worker;
+
+struct Walker {
+    Worker *workers;
+    int count;
+    int ordered;
+    const FilePredicates *predicates;
+    char terminator;
+    atomic_long pending;    // Directories queued or being processed
+    atomic_long queued;     // Directories waiting in some deque
+    atomic_int idle;        // Workers sleeping on idle_cond
+    atomic_int has_error;
+    pthread_mutex_t idle_lock;
+    pthread_cond_t idle_cond;
+    pthread_mutex_t output_lock;
+};
+
+/**
+ * Push job at the tail of a deque
+ * Returns 0 on success, 1 on allocation failure
+ */
+static int deque_push(JobDeque *deque, DirJob *job) {
+    pthread_mutex_lock(&deque->lock);
+
+    if (deque->tail == deque->capacity) {
+        if (deque->head > 0) {
+            // Reclaim space left by thieves
+            memmove(deque->items, deque->items + deque->head,
+                    (deque->tail - deque->head) * sizeof(DirJob*));
+            deque->tail -= deque->head;
+            deque->head = 0;
+        } else {
+            int new_capacity = deque->capacity ? deque->capacity * 2 : DEQUE_INITIAL_CAPACITY;
+            DirJob **tmp = realloc(deque->items, new_capacity * sizeof(DirJob*));
+            if (tmp == NULL) {
+                pthread_mutex_unlock(&deque->lock);
+                return 1;
+            }
+            deque->items = tmp;
+            deque->capacity = new_capacity;
+        }
+    }
+
+    deque->items[deque->tail++] = job;
+    pthread_mutex_unlock(&deque->lock);
+    return 0;
+}
+
+/**
+ * Pop most recently pushed job (owner side)
+ */
+static DirJob* deque_pop(JobDeque *deque) {
+    DirJob *job = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail > deque->head) {
+        job = deque->items[--deque->tail];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return job;
+}
+
+/**
+ * Take oldest job (thief side)
+ * Oldest jobs are closest to the root and tend to carry the largest subtrees
+ */
+static DirJob* deque_steal(JobDeque *deque) {
+    DirJob *job = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail > deque->head) {
+        job = deque->items[deque->head++];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return job;
+}
+
+/**
+ * Queue a directory on the worker's own deque and wake an idle worker
+ * Returns 0 on success, 1 on error
+ */
+static int submit_job(Worker *worker, DirJob *job) {
+    Walker *walker = worker->walker;
+
+    atomic_fetch_add(&walker->pending, 1);
+    if (deque_push(&worker->deque, job) != 0) {
+        atomic_fetch_sub(&walker->pending, 1);
+        return 1;
+    }
+    atomic_fetch_add(&walker->queued, 1);
+
+    if (atomic_load(&walker->idle) > 0) {
+        pthread_mutex_lock(&walker->idle_lock);
+        pthread_cond_signal(&walker->idle_cond);
+        pthread_mutex_unlock(&walker->idle_lock);
+    }
+    return 0;
+}
+
+/**
+ * Get next job: own deque first, then steal from the other workers
+ */
+static DirJob* next_job(Worker *worker) {
+    Walker *walker = worker->walker;
+
+    DirJob *job = deque_pop(&worker->deque);
+    for (int i = 1; job == NULL && i < walker->count; i++) {
+        Worker *victim = &walker->workers[(worker->index + i) % walker->count];
+        job = deque_steal(&victim->deque);
+    }
+
+    if (job != NULL) {
+        atomic_fetch_sub(&walker->queued, 1);
+    }
+    return job;
+}
+
+/**
+ * Write buffered output of a worker to stdout
+ */
+static void flush_output(Worker *worker) {
+    if (worker->output_len == 0) return;
+
+    pthread_mutex_lock(&worker->walker->output_lock);
+    fwrite(worker->output, 1, worker->output_len, stdout);
+    pthread_mutex_unlock(&worker->walker->output_lock);
+    worker->output_len = 0;
+}
+
+/**
+ * Append path record to worker's output buffer (unordered mode)
+ */
+static void emit_path(Worker *worker, const char *path, size_t len) {
+    if (worker->output_len + len + 1 > OUTPUT_BUFFER_SIZE) {
+        flush_output(worker);
+    }
+    memcpy(worker->output + worker->output_len, path, len);
+    worker->output[worker->output_len + len] = worker->walker->terminator;
+    worker->output_len += len + 1;
+}
+
+/**
+ * Append entry slot to an ordered-mode directory result
+ * Returns pointer to the new slot, or NULL on allocation failure
+ */
+static WalkEntry* add_walk_entry(WalkDir *dir) {
+    if (dir->count == dir->capacity) {
+        int new_capacity = dir->capacity ? dir->capacity * 2 : 16;
+        WalkEntry *tmp = realloc(dir->items, new_capacity * sizeof(WalkEntry));
+        if (tmp == NULL) return NULL;
+        dir->items = tmp;
+        dir->capacity = new_capacity;
+    }
+
+    WalkEntry *entry = &dir->items[dir->count++];
+    entry->path = NULL;
+    entry->child = NULL;
+    return entry;
+}
+
+/**
+ * Queue a subdirectory for processing
+ * Returns 0 on success, 1 on error
+ */
+static int spawn_subdirectory(Worker *worker, DirJob *parent, const char *fullpath) {
+    DirJob *job = malloc(sizeof(DirJob));
+    if (job == NULL) return 1;
+
+    job->path = strdup(fullpath);
+    job->depth = parent->depth + 1;
+    job->result = NULL;
+    if (job->path == NULL) {
+        free(job);
+        return 1;
+    }
+
+    if (worker->walker->ordered) {
+        WalkEntry *entry = add_walk_entry(parent->result);
+        WalkDir *child = calloc(1, sizeof(WalkDir));
+        if (entry == NULL || child == NULL) {
+            if (entry != NULL) parent->result->count--;
+            free(child);
+            free(job->path);
+            free(job);
+            return 1;
+        }
+        entry->child = child;
+        job->result = child;
+    }
+
+    if (submit_job(worker, job) != 0) {
+        // Slot stays in the ordered result as an empty directory
+        free(job->path);
+        free(job);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * List one directory: queue subdirectories, emit or record matching files
+ * Jobs carry paths rather than open descriptors so a deep queue cannot exhaust fds
+ */
+static void process_job(Worker *worker, DirJob *job) {
+    Walker *walker = worker->walker;
+    DIR *dir;
+    struct dirent *entry;
+    char fullpath[PATH_MAX];
+
+    int fd = open_directory(AT_FDCWD, job->path, job->depth > 0 ? O_NOFOLLOW : 0);
+    dir = fd == -1 ? NULL : fdopendir(fd);
+    if (dir == NULL) {
+        if (fd != -1) close(fd);
+        fprintf(stderr, "Cannot open directory: %s\n", job->path);
+        atomic_store(&walker->has_error, 1);
+        return;
+    }
+
+    while ((entry = readdir(dir)) != NULL) {
+        EntryKind kind = classify_entry(fd, job->path, entry);
+        if (kind == ENTRY_SKIP) {
+            continue;
+        }
+
+        // Only build the full path for entries that are emitted or queued
+        if (kind == ENTRY_FILE && (!match_filename(entry->d_name, worker->pattern) ||
+                                   !match_predicates(walker->predicates, fd, entry->d_name))) {
+            continue;
+        }
+
+        int len = join_path(fullpath, sizeof(fullpath), job->path, entry->d_name);
+        if (len < 0) {
+            fprintf(stderr, "Path too long: %s/%s\n", job->path, entry->d_name);
+            continue;
+        }
+
+        if (kind == ENTRY_DIR) {
+            if (spawn_subdirectory(worker, job, fullpath) != 0) {
+                fprintf(stderr, "Failed to queue directory: %s\n", fullpath);
+                atomic_store(&walker->has_error, 1);
+            }
+        } else if (walker->ordered) {
+            WalkEntry *slot = add_walk_entry(job->result);
+            if (slot == NULL || (slot->path = strdup(fullpath)) == NULL) {
+                if (slot != NULL) job->result->count--;
+                fprintf(stderr, "Failed to allocate memory for path\n");
+                atomic_store(&walker->has_error, 1);
+            }
+        } else {
+            emit_path(worker, fullpath, len);
+        }
+    }
+
+    closedir(dir);
+}
+
+/**
+ * Worker thread main loop
+ * Exits when no directory is queued or being processed by any worker
+ */
+static void* worker_main(void *arg) {
+    Worker *worker = arg;
+    Walker *walker = worker->walker;
+
+    for (;;) {
+        DirJob *job = next_job(worker);
+        if (job != NULL) {
+            process_job(worker, job);
+            free(job->path);
+            free(job);
+
+            if (atomic_fetch_sub(&walker->pending, 1) == 1) {
+                // Last directory finished - release sleeping workers
+                pthread_mutex_lock(&walker->idle_lock);
+                pthread_cond_broadcast(&walker->idle_cond);
+                pthread_mutex_unlock(&walker->idle_lock);
+            }
+            continue;
+        }
+
+        pthread_mutex_lock(&walker->idle_lock);
+        atomic_fetch_add(&walker->idle, 1);
+        while (atomic_load(&walker->queued) == 0 && atomic_load(&walker->pending) > 0) {
+            pthread_cond_wait(&walker->idle_cond, &walker->idle_lock);
+        }
+        atomic_fetch_sub(&walker->idle, 1);
+        int done = (atomic_load(&walker->pending) == 0);
+        pthread_mutex_unlock(&walker->idle_lock);
+
+        if (done) break;
+    }
+
+    flush_output(worker);
+    return NULL;
+}
+
+/**
+ * Print ordered-mode results depth-first and free them
+ * Uses an explicit stack so deep trees do not exhaust the C stack
+ */
+static void emit_walk_dir(WalkDir *root, char terminator) {
+    typedef struct {
+        WalkDir *dir;
+        int next;
+    } EmitFrame;
+
+    EmitFrame *stack = malloc(64 * sizeof(EmitFrame));
+    int capacity = 64;
+    int depth = 0;
+
+    if (stack == NULL) {
+        fprintf(stderr, "Failed to allocate memory for output\n");
+        return;
+    }
+    stack[depth++] = (EmitFrame){root, 0};
+
+    while (depth > 0) {
+        EmitFrame *frame = &stack[depth - 1];
+
+        if (frame->next == frame->dir->count) {
+            free(frame->dir->items);
+            if (frame->dir != root) free(frame->dir);
+            depth--;
+            continue;
+        }
+
+        WalkEntry *entry = &frame->dir->items[frame->next++];
+        if (entry->path != NULL) {
+            print_path(entry->path, terminator);
+            free(entry->path);
+        } else if (entry->child != NULL) {
+            if (depth == capacity) {
+                EmitFrame *tmp = realloc(stack, capacity * 2 * sizeof(EmitFrame));
+                if (tmp == NULL) {
+                    // Skip the subtree rather than lose the rest of the output
+                    fprintf(stderr, "Failed to allocate memory for output\n");
+                    continue;
+                }
+                stack = tmp;
+                capacity *= 2;
+            }
+            stack[depth++] = (EmitFrame){entry->child, 0};
+        }
+    }
+
+    free(stack);
+}
+
+/**
+ * Walk directory tree with a pool of work-stealing threads
+ * Returns 0 on success, 1 if any directory could not be processed
+ */
+int walk_parallel(const char *root, const FindOptions *opts) {
+    Walker walker;
+    WalkDir root_result = {NULL, 0, 0};
+    int started = 0;
+
+    walker.count = opts->threads;
+    walker.ordered = opts->ordered;
+    walker.predicates = &opts->predicates;
+    walker.terminator = opts->terminator;
+    atomic_init(&walker.pending, 0);
+    atomic_init(&walker.queued, 0);
+    atomic_init(&walker.idle, 0);
+    atomic_init(&walker.has_error, 0);
+    pthread_mutex_init(&walker.idle_lock, NULL);
+    pthread_cond_init(&walker.idle_cond, NULL);
+    pthread_mutex_init(&walker.output_lock, NULL);
+
+    walker.workers = calloc(walker.count, sizeof(Worker));
+    if (walker.workers == NULL) {
+        fprintf(stderr, "Failed to allocate worker threads\n");
+        return 1;
+    }
+
+    // Each worker compiles its own matcher: a shared regex_t serializes regexec()
+    for (int i = 0; i < walker.count; i++) {
+        Worker *worker = &walker.workers[i];
+        worker->walker = &walker;
+        worker->index = i;
+        pthread_mutex_init(&worker->deque.lock, NULL);
+        if (opts->pattern_count > 0) {
+            if (compile_matcher(opts->patterns, opts->pattern_count, &worker->matcher) != 0) {
+                walker.count = i;
+                atomic_store(&walker.has_error, 1);
+                goto cleanup;
+            }
+            worker->pattern = &worker->matcher;
+        }
+    }
+
+    // Seed the walk with the root directory
+    DirJob *root_job = malloc(sizeof(DirJob));
+    if (root_job == NULL || (root_job->path = strdup(root)) == NULL) {
+        free(root_job);
+        fprintf(stderr, "Failed to allocate memory for path\n");
+        atomic_store(&walker.has_error, 1);
+        goto cleanup;
+    }
+    root_job->depth = 0;
+    root_job->result = walker.ordered ? &root_result : NULL;
+    submit_job(&walker.workers[0], root_job);
+
+    for (started = 0; started < walker.count; started++) {
+        Worker *worker = &walker.workers[started];
+        if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0) {
+            fprintf(stderr, "Failed to start worker thread\n");
+            atomic_store(&walker.has_error, 1);
+            break;
+        }
+    }
+
+    // Any started worker drains the whole tree, so a partial pool still completes
+    if (started == 0) {
+        worker_main(&walker.workers[0]);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(walker.workers[i].thread, NULL);
+    }
+
+    if (walker.ordered) {
+        emit_walk_dir(&root_result, walker.terminator);
+    }
+
+cleanup:
+    for (int i = 0; i < walker.count; i++) {
+        if (walker.workers[i].pattern != NULL) {
+            free_matcher(&walker.workers[i].matcher);
+        }
+    }
+    for (int i = 0; i < opts->threads; i++) {
+        free(walker.workers[i].deque.items);
+        pthread_mutex_destroy(&walker.workers[i].deque.lock);
+    }
+    free(walker.workers);
+    pthread_mutex_destroy(&walker.idle_lock);
+    pthread_cond_destroy(&walker.idle_cond);
+    pthread_mutex_destroy(&walker.output_lock);
+
+    return atomic_load(&walker.has_error);
+}
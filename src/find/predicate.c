@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "walk.h"
+
+#define SECONDS_PER_DAY 86400
+
+/**
+ * Split "[+-]N" into a comparison and a number
+ * Returns pointer past the digits, or NULL if there are none
+ */
+static const char* parse_comparison(const char *arg, int *cmp, long long *value) {
+    char *end;
+
+    *cmp = CMP_EQUAL;
+    if (*arg == '+') {
+        *cmp = CMP_GREATER;
+        arg++;
+    } else if (*arg == '-') {
+        *cmp = CMP_LESS;
+        arg++;
+    }
+
+    if (*arg < '0' || *arg > '9') {
+        return NULL;
+    }
+
+    errno = 0;
+    *value = strtoll(arg, &end, 10);
+    if (errno != 0) {
+        return NULL;
+    }
+    return end;
+}
+
+/**
+ * Parse --newer FILE: files modified after FILE pass
+ * Returns 0 on success, 1 on error (message printed to stderr)
+ */
+int parse_newer_predicate(const char *file, FilePredicates *predicates) {
+    struct stat st;
+
+    if (stat(file, &st) != 0) {
+        fprintf(stderr, "Error: Cannot stat --newer reference %s: %s\n", file, strerror(errno));
+        return 1;
+    }
+
+    predicates->newer = st.st_mtim;
+    predicates->flags |= PREDICATE_NEWER;
+    return 0;
+}
+
+/**
+ * Parse --mtime [+-]N: age in whole days, more than (+), less than (-) or exactly N
+ * Returns 0 on success, 1 on error (message printed to stderr)
+ */
+int parse_mtime_predicate(const char *arg, FilePredicates *predicates) {
+    const char *end = parse_comparison(arg, &predicates->mtime_cmp, &predicates->mtime_days);
+
+    if (end == NULL || *end != '\0') {
+        fprintf(stderr, "Error: --mtime expects [+-]N days, got: %s\n", arg);
+        return 1;
+    }
+
+    predicates->flags |= PREDICATE_MTIME;
+    return 0;
+}
+
+/**
+ * Parse --size [+-]N[ckMG]: size in units (bytes by default), rounded up
+ * Returns 0 on success, 1 on error (message printed to stderr)
+ */
+int parse_size_predicate(const char *arg, FilePredicates *predicates) {
+    const char *end = parse_comparison(arg, &predicates->size_cmp, &predicates->size_units);
+
+    if (end != NULL) {
+        switch (*end) {
+            case '\0':
+            case 'c':
+                predicates->size_unit = 1;
+                break;
+            case 'k':
+                predicates->size_unit = 1024LL;
+                break;
+            case 'M':
+                predicates->size_unit = 1024LL * 1024;
+                break;
+            case 'G':
+                predicates->size_unit = 1024LL * 1024 * 1024;
+                break;
+            default:
+                end = NULL;
+        }
+    }
+
+    if (end == NULL || (*end != '\0' && end[1] != '\0')) {
+        fprintf(stderr, "Error: --size expects [+-]N[ckMG], got: %s\n", arg);
+        return 1;
+    }
+
+    predicates->flags |= PREDICATE_SIZE;
+    return 0;
+}
+
+/**
+ * Apply a parsed comparison to value
+ */
+static int compare(int cmp, long long value, long long expected) {
+    switch (cmp) {
+        case CMP_GREATER:
+            return value > expected;
+        case CMP_LESS:
+            return value < expected;
+        default:
+            return value == expected;
+    }
+}
+
+/**
+ * Check a file against the active predicates
+ * Stats name relative to dirfd (AT_FDCWD with a full path) without following symlinks
+ * Returns 1 if the file passes (or no predicate is active), 0 otherwise
+ */
+int match_predicates(const FilePredicates *predicates, int dirfd, const char *name) {
+    struct stat st;
+
+    if (predicates == NULL || predicates->flags == 0) {
+        return 1;
+    }
+
+    // A file removed since its directory was listed is simply not printed
+    if (fstatat(dirfd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+        return 0;
+    }
+
+    if (predicates->flags & PREDICATE_NEWER) {
+        if (st.st_mtim.tv_sec < predicates->newer.tv_sec ||
+            (st.st_mtim.tv_sec == predicates->newer.tv_sec &&
+             st.st_mtim.tv_nsec <= predicates->newer.tv_nsec)) {
+            return 0;
+        }
+    }
+
+    if (predicates->flags & PREDICATE_MTIME) {
+        long long age = ((long long)predicates->now - (long long)st.st_mtim.tv_sec) / SECONDS_PER_DAY;
+        if (!compare(predicates->mtime_cmp, age, predicates->mtime_days)) {
+            return 0;
+        }
+    }
+
+    if (predicates->flags & PREDICATE_SIZE) {
+        long long units = ((long long)st.st_size + predicates->size_unit - 1) / predicates->size_unit;
+        if (!compare(predicates->size_cmp, units, predicates->size_units)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
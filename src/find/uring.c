@@ -0,0 +1,432 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <regex.h>
+#include "walk.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HAVE_IO_URING 1
+#endif
+#endif
+
+#ifdef HAVE_IO_URING
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#define URING_ENTRIES 64
+#define URING_PROBE_OPS 256
+
+/**
+ * Submission and completion rings mapped from the kernel
+ */
+typedef struct {
+    int fd;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned sq_entries;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ptr;
+    void *cq_ptr;
+    size_t sq_size;
+    size_t cq_size;
+    size_t sqes_size;
+    unsigned to_submit;
+} Ring;
+
+typedef enum {
+    OP_OPEN_DIR,   // openat() of a directory, listing happens on completion
+    OP_STATX       // statx() of an entry whose d_type was DT_UNKNOWN
+} UringOpType;
+
+/**
+ * One asynchronous operation, also kept in the pending FIFO before submission
+ */
+typedef struct UringOp {
+    UringOpType type;
+    int depth;
+    char *path;
+    struct statx stx;
+    struct UringOp *next;
+} UringOp;
+
+typedef struct {
+    Ring ring;
+    const Matcher *pattern;
+    char terminator;
+    UringOp *pending_head;
+    UringOp *pending_tail;
+    int inflight;
+    int has_error;
+} UringWalk;
+
+/**
+ * Map the rings of an io_uring instance
+ * Returns 0 on success, -1 if io_uring is unavailable
+ */
+static int ring_init(Ring *ring, unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(ring, 0, sizeof(*ring));
+
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) {
+        return -1;
+    }
+
+    ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_size > ring->sq_size) ring->sq_size = ring->cq_size;
+        ring->cq_size = ring->sq_size;
+    }
+
+    ring->sq_ptr = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ptr == MAP_FAILED) {
+        close(ring->fd);
+        return -1;
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ptr = ring->sq_ptr;
+    } else {
+        ring->cq_ptr = mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ptr == MAP_FAILED) {
+            munmap(ring->sq_ptr, ring->sq_size);
+            close(ring->fd);
+            return -1;
+        }
+    }
+
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        if (ring->cq_ptr != ring->sq_ptr) munmap(ring->cq_ptr, ring->cq_size);
+        munmap(ring->sq_ptr, ring->sq_size);
+        close(ring->fd);
+        return -1;
+    }
+
+    char *sq = ring->sq_ptr;
+    char *cq = ring->cq_ptr;
+    ring->sq_head = (unsigned *)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+    ring->sq_entries = params.sq_entries;
+    ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    return 0;
+}
+
+/**
+ * Unmap rings and close the io_uring descriptor
+ */
+static void ring_cleanup(Ring *ring) {
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ptr != ring->sq_ptr) munmap(ring->cq_ptr, ring->cq_size);
+    munmap(ring->sq_ptr, ring->sq_size);
+    close(ring->fd);
+}
+
+/**
+ * Check that the kernel implements the opcodes the walker relies on
+ * Returns 1 if OPENAT and STATX are supported, 0 otherwise
+ */
+static int ring_supports_ops(Ring *ring) {
+    size_t size = sizeof(struct io_uring_probe) + URING_PROBE_OPS * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = calloc(1, size);
+    if (probe == NULL) return 0;
+
+    int supported = 0;
+    if (syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PROBE, probe, URING_PROBE_OPS) == 0) {
+        supported = probe->last_op >= IORING_OP_STATX &&
+                    (probe->ops[IORING_OP_OPENAT].flags & IO_URING_OP_SUPPORTED) &&
+                    (probe->ops[IORING_OP_STATX].flags & IO_URING_OP_SUPPORTED);
+    }
+
+    free(probe);
+    return supported;
+}
+
+/**
+ * Get a free submission queue entry, or NULL if the queue is full
+ */
+static struct io_uring_sqe* ring_get_sqe(Ring *ring) {
+    unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    unsigned tail = *ring->sq_tail;
+
+    if (tail - head >= ring->sq_entries) {
+        return NULL;
+    }
+
+    unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_array[index] = index;
+    return sqe;
+}
+
+/**
+ * Publish the entry returned by the last ring_get_sqe() call
+ */
+static void ring_commit_sqe(Ring *ring) {
+    __atomic_store_n(ring->sq_tail, *ring->sq_tail + 1, __ATOMIC_RELEASE);
+    ring->to_submit++;
+}
+
+/**
+ * Submit queued entries and wait for at least one completion
+ * Returns 0 on success, -1 on error
+ */
+static int ring_submit_and_wait(Ring *ring) {
+    for (;;) {
+        long ret = syscall(__NR_io_uring_enter, ring->fd, ring->to_submit, 1,
+                           IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret >= 0) {
+            ring->to_submit -= (unsigned)ret;
+            return 0;
+        }
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+/**
+ * Append operation to the pending FIFO
+ */
+static void queue_op(UringWalk *walk, UringOpType type, const char *path, int depth) {
+    UringOp *op = malloc(sizeof(UringOp));
+    if (op == NULL || (op->path = strdup(path)) == NULL) {
+        free(op);
+        fprintf(stderr, "Failed to allocate memory for path\n");
+        walk->has_error = 1;
+        return;
+    }
+
+    op->type = type;
+    op->depth = depth;
+    op->next = NULL;
+
+    if (walk->pending_tail != NULL) {
+        walk->pending_tail->next = op;
+    } else {
+        walk->pending_head = op;
+    }
+    walk->pending_tail = op;
+}
+
+static void free_op(UringOp *op) {
+    free(op->path);
+    free(op);
+}
+
+/**
+ * Print file path if its name matches the pattern
+ */
+static void emit_file(UringWalk *walk, const char *fullpath) {
+    const char *filename = strrchr(fullpath, '/');
+    filename = filename ? filename + 1 : fullpath;
+
+    if (match_filename(filename, walk->pattern)) {
+        print_path(fullpath, walk->terminator);
+    }
+}
+
+/**
+ * Read an opened directory and queue follow-up operations
+ * Directory reads stay synchronous: io_uring has no getdents opcode
+ */
+static void list_directory(UringWalk *walk, UringOp *op, int fd) {
+    char fullpath[PATH_MAX];
+    struct dirent *entry;
+
+    DIR *dir = fdopendir(fd);
+    if (dir == NULL) {
+        close(fd);
+        fprintf(stderr, "Cannot open directory: %s\n", op->path);
+        walk->has_error = 1;
+        return;
+    }
+
+    while ((entry = readdir(dir)) != NULL) {
+        // Skip ., .. and hidden files
+        if (entry->d_name[0] == '.' || entry->d_type == DT_LNK) {
+            continue;
+        }
+
+        int is_file = entry->d_type != DT_DIR && entry->d_type != DT_UNKNOWN;
+        if (is_file && !match_filename(entry->d_name, walk->pattern)) {
+            continue;
+        }
+
+        if (join_path(fullpath, sizeof(fullpath), op->path, entry->d_name) < 0) {
+            fprintf(stderr, "Path too long: %s/%s\n", op->path, entry->d_name);
+            continue;
+        }
+
+        if (is_file) {
+            print_path(fullpath, walk->terminator);
+        } else if (entry->d_type == DT_DIR) {
+            queue_op(walk, OP_OPEN_DIR, fullpath, op->depth + 1);
+        } else {
+            queue_op(walk, OP_STATX, fullpath, op->depth);
+        }
+    }
+
+    closedir(dir);
+}
+
+/**
+ * Handle one completion
+ */
+static void complete_op(UringWalk *walk, UringOp *op, int res) {
+    if (op->type == OP_OPEN_DIR) {
+        if (res < 0) {
+            fprintf(stderr, "Cannot open directory: %s\n", op->path);
+            walk->has_error = 1;
+        } else {
+            list_directory(walk, op, res);
+        }
+    } else {
+        if (res < 0) {
+            fprintf(stderr, "Cannot stat %s: %s\n", op->path, strerror(-res));
+        } else if (S_ISDIR(op->stx.stx_mode)) {
+            queue_op(walk, OP_OPEN_DIR, op->path, op->depth + 1);
+        } else if (!S_ISLNK(op->stx.stx_mode)) {
+            emit_file(walk, op->path);
+        }
+    }
+    free_op(op);
+}
+
+/**
+ * Move pending operations into the submission queue
+ */
+static void fill_submissions(UringWalk *walk) {
+    while (walk->pending_head != NULL && walk->inflight < URING_ENTRIES) {
+        UringOp *op = walk->pending_head;
+
+        struct io_uring_sqe *sqe = ring_get_sqe(&walk->ring);
+        if (sqe == NULL) break;
+
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (unsigned long)op->path;
+        sqe->user_data = (unsigned long)op;
+        if (op->type == OP_OPEN_DIR) {
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->open_flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC | (op->depth > 0 ? O_NOFOLLOW : 0);
+        } else {
+            sqe->opcode = IORING_OP_STATX;
+            sqe->len = STATX_TYPE;
+            sqe->off = (unsigned long)&op->stx;
+            sqe->statx_flags = AT_SYMLINK_NOFOLLOW;
+        }
+        ring_commit_sqe(&walk->ring);
+
+        walk->pending_head = op->next;
+        if (walk->pending_head == NULL) walk->pending_tail = NULL;
+        walk->inflight++;
+    }
+}
+
+/**
+ * Drain the completion queue
+ */
+static void reap_completions(UringWalk *walk) {
+    Ring *ring = &walk->ring;
+    unsigned head = *ring->cq_head;
+    unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+    while (head != tail) {
+        struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+        UringOp *op = (UringOp *)(unsigned long)cqe->user_data;
+        int res = cqe->res;
+
+        head++;
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+        walk->inflight--;
+
+        complete_op(walk, op, res);
+        tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    }
+}
+
+/**
+ * Walk directory tree keeping up to URING_ENTRIES openat/statx operations in flight
+ * Returns 0 on success, 1 on error, WALK_UNSUPPORTED if io_uring cannot be used
+ */
+int walk_uring(const char *root, const Matcher *pattern, char terminator) {
+    UringWalk walk;
+    memset(&walk, 0, sizeof(walk));
+    walk.pattern = pattern;
+    walk.terminator = terminator;
+
+    if (ring_init(&walk.ring, URING_ENTRIES) != 0) {
+        return WALK_UNSUPPORTED;
+    }
+    if (!ring_supports_ops(&walk.ring)) {
+        ring_cleanup(&walk.ring);
+        return WALK_UNSUPPORTED;
+    }
+
+    queue_op(&walk, OP_OPEN_DIR, root, 0);
+
+    while (walk.pending_head != NULL || walk.inflight > 0) {
+        fill_submissions(&walk);
+        if (walk.inflight == 0) continue;
+
+        if (ring_submit_and_wait(&walk.ring) != 0) {
+            fprintf(stderr, "io_uring_enter failed: %s\n", strerror(errno));
+            walk.has_error = 1;
+            break;
+        }
+        reap_completions(&walk);
+    }
+
+    // Only reached with leftovers after a fatal ring error
+    while (walk.pending_head != NULL) {
+        UringOp *op = walk.pending_head;
+        walk.pending_head = op->next;
+        free_op(op);
+    }
+
+    ring_cleanup(&walk.ring);
+    return walk.has_error;
+}
+
+#else
+
+/**
+ * io_uring is not available on this platform
+ */
+int walk_uring(const char *root, const Matcher *pattern, char terminator) {
+    (void)root;
+    (void)pattern;
+    (void)terminator;
+    return WALK_UNSUPPORTED;
+}
+
+#endif /* HAVE_IO_URING */
@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <limits.h>
+#include "walk.h"
+
+/**
+ * Build "dir/name" into buf, avoiding double slashes
+ * Returns length of the resulting path, or -1 if it does not fit
+ */
+int join_path(char *buf, size_t size, const char *dir, const char *name) {
+    size_t dir_len = strlen(dir);
+    int has_trailing_slash = (dir_len > 0 && dir[dir_len - 1] == '/');
+    int len;
+
+    if (has_trailing_slash) {
+        len = snprintf(buf, size, "%s%s", dir, name);
+    } else {
+        len = snprintf(buf, size, "%s/%s", dir, name);
+    }
+
+    if (len < 0 || (size_t)len >= size) {
+        return -1;
+    }
+    return len;
+}
+
+/**
+ * Open directory relative to parent_fd (AT_FDCWD for plain paths)
+ * Pass O_NOFOLLOW in flags to refuse symlinks (used for subdirectories)
+ * Returns file descriptor, or -1 on error
+ */
+int open_directory(int parent_fd, const char *name, int flags) {
+    return openat(parent_fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC | flags);
+}
+
+/**
+ * Decide whether an entry should be skipped, printed or descended into
+ * Skips ".", "..", hidden entries and symbolic links
+ * Uses d_type from readdir and only stats when the filesystem reports DT_UNKNOWN
+ */
+EntryKind classify_entry(int dirfd, const char *dirpath, const struct dirent *entry) {
+    struct stat statbuf;
+
+    // Skip ., .. and hidden files
+    if (entry->d_name[0] == '.') {
+        return ENTRY_SKIP;
+    }
+
+    switch (entry->d_type) {
+        case DT_DIR:
+            return ENTRY_DIR;
+        case DT_LNK:
+            // Skip symbolic links to prevent loops
+            return ENTRY_SKIP;
+        case DT_UNKNOWN:
+            break;
+        default:
+            return ENTRY_FILE;
+    }
+
+    // Filesystem does not report types - stat relative to the directory
+    if (fstatat(dirfd, entry->d_name, &statbuf, AT_SYMLINK_NOFOLLOW) == -1) {
+        fprintf(stderr, "Cannot stat %s/%s: %s\n", dirpath, entry->d_name, strerror(errno));
+        return ENTRY_SKIP;
+    }
+
+    if (S_ISLNK(statbuf.st_mode)) {
+        return ENTRY_SKIP;
+    }
+
+    return S_ISDIR(statbuf.st_mode) ? ENTRY_DIR : ENTRY_FILE;
+}
+
+/**
+ * Append one entry to an owned listing
+ * Returns 0 on success, 1 on allocation failure
+ */
+static int listing_add(Listing *listing, const char *name, EntryKind kind) {
+    size_t name_len = strlen(name) + 1;
+
+    if (listing->count == listing->items_cap) {
+        int new_cap = listing->items_cap ? listing->items_cap * 2 : 32;
+        ListingEntry *tmp = realloc(listing->items_buf, new_cap * sizeof(ListingEntry));
+        if (tmp == NULL) return 1;
+        listing->items_buf = tmp;
+        listing->items_cap = new_cap;
+    }
+
+    if (listing->names_len + name_len > listing->names_cap) {
+        size_t new_cap = listing->names_cap ? listing->names_cap * 2 : 1024;
+        while (new_cap < listing->names_len + name_len) new_cap *= 2;
+        char *tmp = realloc(listing->names_buf, new_cap);
+        if (tmp == NULL) return 1;
+        listing->names_buf = tmp;
+        listing->names_cap = new_cap;
+    }
+
+    memcpy(listing->names_buf + listing->names_len, name, name_len);
+    listing->items_buf[listing->count].name = (uint32_t)listing->names_len;
+    listing->items_buf[listing->count].kind = kind;
+    listing->names_len += name_len;
+    listing->count++;
+    return 0;
+}
+
+/**
+ * Read all entries of an open directory into listing, classifying each one
+ * dirpath is used for error messages only
+ * Returns 0 on success, 1 on allocation failure
+ */
+int read_listing(DIR *dir, const char *dirpath, Listing *listing) {
+    struct dirent *entry;
+    int fd = dirfd(dir);
+
+    memset(listing, 0, sizeof(*listing));
+
+    while ((entry = readdir(dir)) != NULL) {
+        // Note ignore files before hidden entries are skipped
+        if (entry->d_name[0] == '.') {
+            if (strcmp(entry->d_name, ".jigignore") == 0) {
+                listing->flags |= LISTING_HAS_JIGIGNORE;
+            } else if (strcmp(entry->d_name, ".gitignore") == 0) {
+                listing->flags |= LISTING_HAS_GITIGNORE;
+            }
+            continue;
+        }
+
+        EntryKind kind = classify_entry(fd, dirpath, entry);
+        if (kind == ENTRY_SKIP) {
+            continue;
+        }
+        if (listing_add(listing, entry->d_name, kind) != 0) {
+            free_listing(listing);
+            return 1;
+        }
+    }
+
+    listing->names = listing->names_buf;
+    listing->items = listing->items_buf;
+    return 0;
+}
+
+/**
+ * Print one path followed by terminator
+ */
+void print_path(const char *path, char terminator) {
+    fputs(path, stdout);
+    putchar(terminator);
+}
+
+/**
+ * Free storage owned by a listing (borrowed listings are left untouched)
+ */
+void free_listing(Listing *listing) {
+    free(listing->names_buf);
+    free(listing->items_buf);
+    memset(listing, 0, sizeof(*listing));
+}
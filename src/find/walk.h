@@ -0,0 +1,286 @@
+#ifndef WALK_H
+#define WALK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <dirent.h>
+#include <time.h>
+#include <regex.h>
+
+#define MAX_THREADS 256
+
+// Returned by an engine that cannot run on this system
+#define WALK_UNSUPPORTED -1
+
+/**
+ * Traversal engine selected with --engine
+ */
+typedef enum {
+    ENGINE_WALK,    // readdir-based walk (serial or --threads)
+    ENGINE_URING    // io_uring with many openat/statx operations in flight
+} FindEngine;
+
+/**
+ * Classification of a directory entry during traversal
+ */
+typedef enum {
+    ENTRY_SKIP,   // Hidden entry, symlink, or entry that could not be inspected
+    ENTRY_FILE,   // Anything that is not a directory (printed if it matches)
+    ENTRY_DIR     // Directory to descend into
+} EntryKind;
+
+/**
+ * Shape of a pattern that needs no regex engine
+ */
+typedef enum {
+    LITERAL_EXACT,      // ^text$
+    LITERAL_PREFIX,     // ^text
+    LITERAL_SUFFIX,     // text$
+    LITERAL_SUBSTRING   // text
+} LiteralKind;
+
+/**
+ * Literal filename pattern
+ *
+ * Fields:
+ *   kind - Where the text must appear in the filename
+ *   text - Unescaped literal, folded to lowercase
+ *   len  - Length of text
+ *   fold - Text contains letters, so comparison must ignore case
+ */
+typedef struct {
+    LiteralKind kind;
+    char *text;
+    size_t len;
+    int fold;
+} LiteralPattern;
+
+/**
+ * Compiled set of -p/--pattern arguments; a filename matches if any pattern does
+ *
+ * Fields:
+ *   literals      - Patterns matched with memcmp()/memmem()
+ *   literal_count - Number of literal patterns
+ *   regexes       - Remaining patterns, normally joined into one alternation
+ *   regex_count   - Number of compiled regexes
+ */
+typedef struct {
+    LiteralPattern *literals;
+    int literal_count;
+    regex_t *regexes;
+    int regex_count;
+} Matcher;
+
+// FilePredicates.flags
+#define PREDICATE_NEWER 0x1
+#define PREDICATE_MTIME 0x2
+#define PREDICATE_SIZE  0x4
+
+// Comparison parsed from a "[+-]N" argument
+#define CMP_EQUAL   0
+#define CMP_GREATER 1
+#define CMP_LESS    2
+
+/**
+ * Metadata tests applied to files that passed the filename patterns
+ * Files are only stat-ed when at least one predicate is active
+ *
+ * Fields:
+ *   flags      - PREDICATE_* bits of active predicates
+ *   newer      - --newer: reference modification time
+ *   now        - Walk start time, base for --mtime ages
+ *   mtime_cmp  - --mtime comparison (CMP_*)
+ *   mtime_days - --mtime age in whole days
+ *   size_cmp   - --size comparison (CMP_*)
+ *   size_units - --size value in size_unit units
+ *   size_unit  - Bytes per unit (1, 1024, ...)
+ */
+typedef struct {
+    int flags;
+    struct timespec newer;
+    time_t now;
+    int mtime_cmp;
+    long long mtime_days;
+    int size_cmp;
+    long long size_units;
+    long long size_unit;
+} FilePredicates;
+
+/**
+ * Options shared by all traversal engines
+ *
+ * Fields:
+ *   patterns      - Raw -p/--pattern arguments
+ *   pattern_count - Number of patterns (0 to print every file)
+ *   threads     - Number of worker threads (1 = serial walk)
+ *   ordered     - Keep serial output order when walking in parallel
+ *   engine      - Traversal engine
+ *   cache       - Reuse listings of unchanged directories from .jig/
+ *   watch       - Keep running and stream changes after the initial walk
+ *   ignore      - LISTING_HAS_* mask of ignore files to honor (0 = none)
+ *   predicates  - --newer / --mtime / --size tests
+ *   terminator  - Output record separator ('\n', or '\0' with -0/--null)
+ */
+typedef struct {
+    const char **patterns;
+    int pattern_count;
+    int threads;
+    int ordered;
+    FindEngine engine;
+    int cache;
+    int watch;
+    uint32_t ignore;
+    FilePredicates predicates;
+    char terminator;
+} FindOptions;
+
+/**
+ * One entry of a directory listing
+ * Layout is shared with the on-disk cache, so fields have fixed width
+ *
+ * Fields:
+ *   name - Offset of the NUL-terminated name in Listing.names
+ *   kind - ENTRY_FILE or ENTRY_DIR
+ */
+typedef struct {
+    uint32_t name;
+    uint32_t kind;
+} ListingEntry;
+
+// Listing.flags: ignore files seen while reading the directory
+#define LISTING_HAS_JIGIGNORE 0x1
+#define LISTING_HAS_GITIGNORE 0x2
+
+/**
+ * Entries of one directory that survived skipping rules, in readdir order
+ * Either owns its storage (read from disk) or borrows it from the cache mapping
+ *
+ * Fields:
+ *   names     - Base of entry names
+ *   items     - Array of entries
+ *   count     - Number of entries
+ *   flags     - LISTING_HAS_* bits for skipped hidden entries of interest
+ *   names_buf - Owned name storage (NULL when borrowed)
+ *   items_buf - Owned entry storage (NULL when borrowed)
+ */
+typedef struct {
+    const char *names;
+    const ListingEntry *items;
+    int count;
+    uint32_t flags;
+    char *names_buf;
+    size_t names_len;
+    size_t names_cap;
+    ListingEntry *items_buf;
+    int items_cap;
+} Listing;
+
+/**
+ * Called by walk_files() with the path of each matching file
+ * path is only valid during the call
+ */
+typedef void (*WalkVisit)(const char *path, void *arg);
+
+/**
+ * Compile -p/--pattern arguments into a matcher
+ * Prints an error message to stderr on failure
+ * Returns 0 on success, 1 on error
+ */
+int compile_matcher(const char *const *patterns, int count, Matcher *matcher);
+
+/**
+ * Free compiled patterns
+ */
+void free_matcher(Matcher *matcher);
+
+/**
+ * Build "dir/name" into buf, avoiding double slashes
+ * Returns length of the resulting path, or -1 if it does not fit
+ */
+int join_path(char *buf, size_t size, const char *dir, const char *name);
+
+/**
+ * Open directory relative to parent_fd (AT_FDCWD for plain paths)
+ * Pass O_NOFOLLOW in flags to refuse symlinks (used for subdirectories)
+ * Returns file descriptor, or -1 on error
+ */
+int open_directory(int parent_fd, const char *name, int flags);
+
+/**
+ * Decide whether an entry should be skipped, printed or descended into
+ * Skips ".", "..", hidden entries and symbolic links
+ * Uses d_type from readdir and only stats when the filesystem reports DT_UNKNOWN
+ * dirpath is used for error messages only
+ */
+EntryKind classify_entry(int dirfd, const char *dirpath, const struct dirent *entry);
+
+/**
+ * Read all entries of an open directory into listing, classifying each one
+ * dirpath is used for error messages only
+ * Returns 0 on success, 1 on allocation failure
+ */
+int read_listing(DIR *dir, const char *dirpath, Listing *listing);
+
+/**
+ * Free storage owned by a listing (borrowed listings are left untouched)
+ */
+void free_listing(Listing *listing);
+
+/**
+ * Print one path followed by terminator
+ */
+void print_path(const char *path, char terminator);
+
+/**
+ * Check filename against an optional matcher
+ * Returns 1 if any pattern matches or matcher is NULL, 0 otherwise
+ */
+int match_filename(const char *filename, const Matcher *matcher);
+
+/**
+ * Parse --newer FILE: files modified after FILE pass
+ * Returns 0 on success, 1 on error (message printed to stderr)
+ */
+int parse_newer_predicate(const char *file, FilePredicates *predicates);
+
+/**
+ * Parse --mtime [+-]N: age in whole days, more than (+), less than (-) or exactly N
+ * Returns 0 on success, 1 on error (message printed to stderr)
+ */
+int parse_mtime_predicate(const char *arg, FilePredicates *predicates);
+
+/**
+ * Parse --size [+-]N[ckMG]: size in units (bytes by default), rounded up
+ * Returns 0 on success, 1 on error (message printed to stderr)
+ */
+int parse_size_predicate(const char *arg, FilePredicates *predicates);
+
+/**
+ * Check a file against the active predicates
+ * Stats name relative to dirfd (AT_FDCWD with a full path) without following symlinks
+ * Returns 1 if the file passes (or no predicate is active), 0 otherwise
+ */
+int match_predicates(const FilePredicates *predicates, int dirfd, const char *name);
+
+/**
+ * Walk directory tree with a pool of work-stealing threads
+ * Returns 0 on success, 1 if any directory could not be processed
+ */
+int walk_parallel(const char *root, const FindOptions *opts);
+
+/**
+ * Walk directory tree with io_uring, keeping many openat/statx operations in flight
+ * Output order differs from the serial walk, the set of paths is the same
+ * Returns 0 on success, 1 on error, WALK_UNSUPPORTED if io_uring cannot be used
+ */
+int walk_uring(const char *root, const Matcher *pattern, char terminator);
+
+/**
+ * Walk the tree under root serially and call visit for each file matching
+ * pattern (NULL for every file), in the order jig find prints them
+ * Hidden entries and symlinks are skipped as by jig find
+ * Returns 0 on success, 1 on error
+ */
+int walk_files(const char *root, const Matcher *pattern, WalkVisit visit, void *arg);
+
+#endif /* WALK_H */
@@ -0,0 +1,462 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include "walk.h"
+#include "watch.h"
+#include "ignore.h"
+
+#define WATCH_EVENT_BUFFER 65536
+#define WATCH_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | \
+                    IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+
+typedef struct WatchDir WatchDir;
+
+/**
+ * Mirror of one watched directory
+ *
+ * Fields:
+ *   wd       - inotify watch descriptor
+ *   path     - Directory path as printed in the output
+ *   parent   - Containing watched directory (NULL for the root)
+ *   children - Watched subdirectories
+ *   files    - Names of printed files (matching the pattern)
+ *   rules    - Ignore rules for entries of this directory (NULL if none)
+ */
+struct WatchDir {
+    int wd;
+    char *path;
+    WatchDir *parent;
+    WatchDir **children;
+    int child_count;
+    int child_cap;
+    char **files;
+    int file_count;
+    int file_cap;
+    IgnoreRules *rules;
+};
+
+struct FindWatch {
+    int fd;
+    const Matcher *pattern;
+    uint32_t ignore;       // LISTING_HAS_* mask of ignore files to honor
+    char terminator;       // Record separator of +path / -path lines
+    WatchDir *root;
+    WatchDir **by_wd;      // Indexed by watch descriptor
+    int by_wd_cap;
+    WatchDir **stack;      // Directories on the current walk path, by depth
+    int stack_cap;
+};
+
+/**
+ * Grow an array of pointers to hold at least need items
+ * Returns 0 on success, 1 on allocation failure
+ */
+static int grow_pointers(void ***items, int *cap, int need) {
+    if (need <= *cap) return 0;
+
+    int new_cap = *cap ? *cap * 2 : 16;
+    while (new_cap < need) new_cap *= 2;
+
+    void **tmp = realloc(*items, new_cap * sizeof(void *));
+    if (tmp == NULL) return 1;
+    memset(tmp + *cap, 0, (new_cap - *cap) * sizeof(void *));
+    *items = tmp;
+    *cap = new_cap;
+    return 0;
+}
+
+/**
+ * Create inotify instance
+ * ignore is the LISTING_HAS_* mask of ignore files honored in new directories
+ * terminator ends each "+path" / "-path" record
+ * Returns FindWatch* or NULL on error (message printed to stderr)
+ */
+FindWatch* watch_open(const Matcher *pattern, uint32_t ignore, char terminator) {
+    FindWatch *watch = calloc(1, sizeof(FindWatch));
+    if (watch == NULL) {
+        fprintf(stderr, "Failed to allocate watch state\n");
+        return NULL;
+    }
+
+    watch->fd = inotify_init1(IN_CLOEXEC);
+    if (watch->fd == -1) {
+        fprintf(stderr, "Cannot initialize inotify: %s\n", strerror(errno));
+        free(watch);
+        return NULL;
+    }
+
+    watch->pattern = pattern;
+    watch->ignore = ignore;
+    watch->terminator = terminator;
+    return watch;
+}
+
+/**
+ * Add watch for path and link it below parent
+ * Returns the new WatchDir, or NULL on error
+ */
+static WatchDir* register_directory(FindWatch *watch, WatchDir *parent, const char *path) {
+    int wd = inotify_add_watch(watch->fd, path, WATCH_MASK | (parent ? IN_DONT_FOLLOW : 0));
+    if (wd == -1) {
+        fprintf(stderr, "Cannot watch directory %s: %s\n", path, strerror(errno));
+        if (errno == ENOSPC) {
+            fprintf(stderr, "Raise fs.inotify.max_user_watches to watch larger trees\n");
+        }
+        return NULL;
+    }
+
+    WatchDir *dir = calloc(1, sizeof(WatchDir));
+    if (dir == NULL || (dir->path = strdup(path)) == NULL ||
+        grow_pointers((void ***)&watch->by_wd, &watch->by_wd_cap, wd + 1) != 0 ||
+        (parent != NULL && grow_pointers((void ***)&parent->children, &parent->child_cap,
+                                         parent->child_count + 1) != 0)) {
+        if (dir != NULL) free(dir->path);
+        free(dir);
+        inotify_rm_watch(watch->fd, wd);
+        fprintf(stderr, "Failed to allocate watch state\n");
+        return NULL;
+    }
+
+    dir->wd = wd;
+    dir->parent = parent;
+    watch->by_wd[wd] = dir;
+    if (parent != NULL) {
+        parent->children[parent->child_count++] = dir;
+    } else {
+        watch->root = dir;
+    }
+    return dir;
+}
+
+/**
+ * Register directory visited by the walk at the given depth (root is 0)
+ * Must be called before the directory is read so no change is missed
+ * Returns 0 on success, 1 on error
+ */
+int watch_add_directory(FindWatch *watch, const char *path, int depth) {
+    if (grow_pointers((void ***)&watch->stack, &watch->stack_cap, depth + 1) != 0) {
+        fprintf(stderr, "Failed to allocate watch state\n");
+        return 1;
+    }
+
+    WatchDir *parent = depth > 0 ? watch->stack[depth - 1] : NULL;
+    if (depth > 0 && parent == NULL) {
+        // Parent could not be watched - its subtree is not watched either
+        watch->stack[depth] = NULL;
+        return 1;
+    }
+
+    watch->stack[depth] = register_directory(watch, parent, path);
+    return watch->stack[depth] == NULL;
+}
+
+/**
+ * Attach the ignore rules of the directory registered at depth
+ * New entries that match them are not reported
+ */
+void watch_set_ignore(FindWatch *watch, int depth, IgnoreRules *rules) {
+    if (depth < watch->stack_cap && watch->stack[depth] != NULL) {
+        ignore_release(watch->stack[depth]->rules);
+        watch->stack[depth]->rules = ignore_retain(rules);
+    }
+}
+
+/**
+ * Check whether dir already lists file name
+ */
+static int has_file(WatchDir *dir, const char *name) {
+    for (int i = 0; i < dir->file_count; i++) {
+        if (strcmp(dir->files[i], name) == 0) return 1;
+    }
+    return 0;
+}
+
+/**
+ * Add file name to dir
+ * Returns 1 if it was added, 0 if already present or on allocation failure
+ */
+static int add_file(WatchDir *dir, const char *name) {
+    if (has_file(dir, name)) return 0;
+
+    if (grow_pointers((void ***)&dir->files, &dir->file_cap, dir->file_count + 1) != 0) {
+        return 0;
+    }
+    dir->files[dir->file_count] = strdup(name);
+    if (dir->files[dir->file_count] == NULL) return 0;
+    dir->file_count++;
+    return 1;
+}
+
+/**
+ * Remove file name from dir
+ * Returns 1 if it was present, 0 otherwise
+ */
+static int remove_file(WatchDir *dir, const char *name) {
+    for (int i = 0; i < dir->file_count; i++) {
+        if (strcmp(dir->files[i], name) == 0) {
+            free(dir->files[i]);
+            dir->files[i] = dir->files[--dir->file_count];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Record file printed by the walk inside the directory registered at depth
+ */
+void watch_add_file(FindWatch *watch, int depth, const char *name) {
+    if (depth < watch->stack_cap && watch->stack[depth] != NULL) {
+        add_file(watch->stack[depth], name);
+    }
+}
+
+/**
+ * Find watched subdirectory of dir by name
+ */
+static WatchDir* find_child(WatchDir *dir, const char *name) {
+    size_t dir_len = strlen(dir->path);
+    int has_trailing_slash = (dir_len > 0 && dir->path[dir_len - 1] == '/');
+
+    for (int i = 0; i < dir->child_count; i++) {
+        const char *child_name = dir->children[i]->path + dir_len + (has_trailing_slash ? 0 : 1);
+        if (strcmp(child_name, name) == 0) return dir->children[i];
+    }
+    return NULL;
+}
+
+/**
+ * Forget a directory and everything below it, printing "-path" for its files
+ */
+static void remove_subtree(FindWatch *watch, WatchDir *dir) {
+    char fullpath[PATH_MAX];
+
+    while (dir->child_count > 0) {
+        remove_subtree(watch, dir->children[dir->child_count - 1]);
+    }
+
+    for (int i = 0; i < dir->file_count; i++) {
+        if (join_path(fullpath, sizeof(fullpath), dir->path, dir->files[i]) >= 0) {
+            putchar('-');
+            print_path(fullpath, watch->terminator);
+        }
+        free(dir->files[i]);
+    }
+
+    // Kernel already dropped watches of deleted directories; moved ones are still active
+    inotify_rm_watch(watch->fd, dir->wd);
+    watch->by_wd[dir->wd] = NULL;
+
+    if (dir->parent != NULL) {
+        WatchDir *parent = dir->parent;
+        for (int i = 0; i < parent->child_count; i++) {
+            if (parent->children[i] == dir) {
+                parent->children[i] = parent->children[--parent->child_count];
+                break;
+            }
+        }
+    } else {
+        watch->root = NULL;
+    }
+
+    ignore_release(dir->rules);
+    free(dir->files);
+    free(dir->children);
+    free(dir->path);
+    free(dir);
+}
+
+/**
+ * Watch a directory that appeared after the initial walk and print "+path"
+ * for its matching files
+ */
+static void scan_new_directory(FindWatch *watch, WatchDir *parent, const char *path,
+                               const char *name) {
+    char fullpath[PATH_MAX];
+    Listing listing;
+
+    // Watch first, then read: files created in between show up twice and are deduplicated
+    WatchDir *dir = register_directory(watch, parent, path);
+    if (dir == NULL) return;
+
+    int fd = open_directory(AT_FDCWD, path, O_NOFOLLOW);
+    DIR *handle = fd == -1 ? NULL : fdopendir(fd);
+    if (handle == NULL) {
+        if (fd != -1) close(fd);
+        return;
+    }
+
+    if (read_listing(handle, path, &listing) != 0) {
+        closedir(handle);
+        return;
+    }
+
+    if (watch->ignore != 0) {
+        dir->rules = ignore_load(ignore_descend(parent->rules, name), dirfd(handle), path,
+                                 listing.flags & watch->ignore);
+    }
+    closedir(handle);
+
+    for (int i = 0; i < listing.count; i++) {
+        const char *entry_name = listing.names + listing.items[i].name;
+        int is_dir = listing.items[i].kind == ENTRY_DIR;
+
+        if ((!is_dir && !match_filename(entry_name, watch->pattern)) ||
+            ignore_match(dir->rules, entry_name, is_dir) ||
+            join_path(fullpath, sizeof(fullpath), path, entry_name) < 0) {
+            continue;
+        }
+
+        if (is_dir) {
+            if (find_child(dir, entry_name) == NULL) {
+                scan_new_directory(watch, dir, fullpath, entry_name);
+            }
+        } else if (add_file(dir, entry_name)) {
+            putchar('+');
+            print_path(fullpath, watch->terminator);
+        }
+    }
+
+    free_listing(&listing);
+}
+
+/**
+ * Apply one inotify event to the mirror and print resulting changes
+ */
+static void handle_event(FindWatch *watch, const struct inotify_event *event) {
+    char fullpath[PATH_MAX];
+    struct stat st;
+
+    if (event->mask & IN_Q_OVERFLOW) {
+        fprintf(stderr, "inotify event queue overflow, some changes were missed\n");
+        return;
+    }
+
+    if (event->wd < 0 || event->wd >= watch->by_wd_cap || watch->by_wd[event->wd] == NULL) {
+        return;  // Event for a directory that is no longer tracked
+    }
+    WatchDir *dir = watch->by_wd[event->wd];
+
+    // Watch dropped by the kernel (directory deleted or unmounted)
+    if (event->mask & IN_IGNORED) {
+        remove_subtree(watch, dir);
+        return;
+    }
+
+    // Root itself went away; other directories are handled through their parents
+    if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+        if (dir == watch->root) {
+            remove_subtree(watch, dir);
+        }
+        return;
+    }
+
+    if (event->len == 0 || event->name[0] == '.') {
+        return;
+    }
+
+    if (join_path(fullpath, sizeof(fullpath), dir->path, event->name) < 0) {
+        return;
+    }
+
+    if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+        if (event->mask & IN_ISDIR) {
+            WatchDir *existing = find_child(dir, event->name);
+            if (existing != NULL && (event->mask & IN_MOVED_TO)) {
+                // Renamed over an existing (empty) directory
+                remove_subtree(watch, existing);
+                existing = NULL;
+            }
+            if (existing == NULL && !ignore_match(dir->rules, event->name, 1)) {
+                scan_new_directory(watch, dir, fullpath, event->name);
+            }
+        } else if (fstatat(AT_FDCWD, fullpath, &st, AT_SYMLINK_NOFOLLOW) == 0 &&
+                   !S_ISLNK(st.st_mode) &&
+                   match_filename(event->name, watch->pattern) &&
+                   !ignore_match(dir->rules, event->name, 0) &&
+                   add_file(dir, event->name)) {
+            putchar('+');
+            print_path(fullpath, watch->terminator);
+        }
+    } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        if (event->mask & IN_ISDIR) {
+            WatchDir *child = find_child(dir, event->name);
+            if (child != NULL) {
+                remove_subtree(watch, child);
+            }
+        } else if (remove_file(dir, event->name)) {
+            putchar('-');
+            print_path(fullpath, watch->terminator);
+        }
+    }
+}
+
+/**
+ * Stream changes to stdout until the watched root disappears or an error occurs
+ * Returns 0 when the root is gone, 1 on error
+ */
+int watch_run(FindWatch *watch) {
+    char buffer[WATCH_EVENT_BUFFER] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    fflush(stdout);
+
+    while (watch->root != NULL) {
+        ssize_t len = read(watch->fd, buffer, sizeof(buffer));
+        if (len == -1 && errno == EINTR) {
+            continue;
+        }
+        if (len <= 0) {
+            fprintf(stderr, "Cannot read inotify events: %s\n", strerror(errno));
+            return 1;
+        }
+
+        for (char *ptr = buffer; ptr < buffer + len; ) {
+            const struct inotify_event *event = (const struct inotify_event *)ptr;
+            handle_event(watch, event);
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+
+        // Downstream tools consume changes as they happen
+        fflush(stdout);
+    }
+
+    return 0;
+}
+
+/**
+ * Free a mirrored subtree without printing anything
+ */
+static void free_subtree(WatchDir *dir) {
+    for (int i = 0; i < dir->child_count; i++) {
+        free_subtree(dir->children[i]);
+    }
+    for (int i = 0; i < dir->file_count; i++) {
+        free(dir->files[i]);
+    }
+    ignore_release(dir->rules);
+    free(dir->files);
+    free(dir->children);
+    free(dir->path);
+    free(dir);
+}
+
+/**
+ * Remove all watches and free state
+ */
+void watch_close(FindWatch *watch) {
+    if (watch == NULL) return;
+
+    if (watch->root != NULL) {
+        free_subtree(watch->root);
+    }
+    close(watch->fd);  // Closing the instance drops every watch
+    free(watch->by_wd);
+    free(watch->stack);
+    free(watch);
+}
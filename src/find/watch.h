@@ -0,0 +1,53 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include "walk.h"
+#include "ignore.h"
+
+/**
+ * inotify state for jig find --watch
+ *
+ * The serial walk registers every directory it visits and every file it
+ * prints; watch_run() then streams "+path" / "-path" lines as files
+ * matching the pattern appear and disappear.
+ */
+typedef struct FindWatch FindWatch;
+
+/**
+ * Create inotify instance
+ * ignore is the LISTING_HAS_* mask of ignore files honored in new directories
+ * terminator ends each "+path" / "-path" record
+ * Returns FindWatch* or NULL on error (message printed to stderr)
+ */
+FindWatch* watch_open(const Matcher *pattern, uint32_t ignore, char terminator);
+
+/**
+ * Register directory visited by the walk at the given depth (root is 0)
+ * Must be called before the directory is read so no change is missed
+ * Returns 0 on success, 1 on error
+ */
+int watch_add_directory(FindWatch *watch, const char *path, int depth);
+
+/**
+ * Attach the ignore rules of the directory registered at depth
+ * New entries that match them are not reported
+ */
+void watch_set_ignore(FindWatch *watch, int depth, IgnoreRules *rules);
+
+/**
+ * Record file printed by the walk inside the directory registered at depth
+ */
+void watch_add_file(FindWatch *watch, int depth, const char *name);
+
+/**
+ * Stream changes to stdout until the watched root disappears or an error occurs
+ * Returns 0 when the root is gone, 1 on error
+ */
+int watch_run(FindWatch *watch);
+
+/**
+ * Remove all watches and free state
+ */
+void watch_close(FindWatch *watch);
+
+#endif /* WATCH_H */
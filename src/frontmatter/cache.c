@@ -0,0 +1,780 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "cache.h"
+
+#define CACHE_MAGIC "JIGNOTE"
+#define CACHE_VERSION 1
+#define CACHE_LOCK_FILE ".jig/frontmatter.cache.lock"
+
+// Files modified this recently are not cached: a change within the same
+// timestamp tick would otherwise go unnoticed on the next run
+#define CACHE_RACY_SECONDS 2
+
+// Offset of an absent string
+#define NO_STRING UINT32_MAX
+
+/**
+ * File header, followed by:
+ *   NoteRecord[note_count]
+ *   uint32_t[table_size]        hash on (dev, ino): record index + 1, 0 if empty
+ *   CachedLink[link_count]      offsets into the string table
+ *   char[strings_size]          NUL-terminated strings
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t note_count;
+    uint32_t table_size;     // Power of two, more than twice note_count
+    uint32_t link_count;
+    uint32_t reserved;
+    uint64_t strings_size;
+    uint64_t checksum;       // FNV-1a of everything after the header
+} CacheHeader;
+
+typedef struct {
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t size;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    uint32_t flags;          // CACHED_*
+    uint32_t id;             // Offsets into the string table, or NO_STRING
+    uint32_t title;
+    uint32_t slug;
+    uint32_t first_link;
+    uint32_t link_count;
+} NoteRecord;
+
+/**
+ * Validated, memory-mapped cache file
+ */
+typedef struct {
+    void *map;
+    size_t map_size;
+    const NoteRecord *notes;
+    uint32_t note_count;
+    const uint32_t *table;
+    uint32_t table_size;
+    const CachedLink *links;
+    const char *strings;
+} CacheFile;
+
+/**
+ * Record stored during this run; its strings and links are owned
+ * (record offsets are relative to strings, first_link is unused)
+ */
+typedef struct {
+    NoteRecord record;
+    char *strings;
+    CachedLink *links;
+} PendingNote;
+
+struct FrontmatterCache {
+    CacheFile file;
+    time_t started;
+    PendingNote *pending;
+    size_t pending_count;
+    size_t pending_cap;
+    uint32_t *pending_table;     // Like the file table, indexes pending
+    size_t pending_table_size;
+    pthread_mutex_t lock;
+};
+
+/**
+ * Growable output section used while writing the cache file
+ */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} Buffer;
+
+/**
+ * 64-bit FNV-1a hash
+ */
+static uint64_t fnv1a(const void *data, size_t len, uint64_t hash) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+
+/**
+ * Hash table slot for a file identity
+ */
+static uint64_t hash_key(uint64_t dev, uint64_t ino) {
+    uint64_t h = (ino ^ (dev << 32) ^ (dev >> 32)) * 0x9e3779b97f4a7c15ULL;
+    h ^= h >> 29;
+    return h;
+}
+
+static int same_version(const NoteRecord *rec, const NoteKey *key) {
+    return rec->dev == key->dev && rec->ino == key->ino && rec->size == key->size &&
+           rec->mtime_sec == key->mtime_sec && rec->mtime_nsec == key->mtime_nsec;
+}
+
+/**
+ * Append len bytes to buffer, growing geometrically
+ * Returns offset of the data, or -1 on allocation failure
+ */
+static int64_t buffer_append(Buffer *buffer, const void *data, size_t len) {
+    if (buffer->len + len > buffer->cap) {
+        size_t new_cap = buffer->cap ? buffer->cap * 2 : 4096;
+        while (new_cap < buffer->len + len) new_cap *= 2;
+        char *tmp = realloc(buffer->data, new_cap);
+        if (tmp == NULL) return -1;
+        buffer->data = tmp;
+        buffer->cap = new_cap;
+    }
+    memcpy(buffer->data + buffer->len, data, len);
+    buffer->len += len;
+    return (int64_t)(buffer->len - len);
+}
+
+/**
+ * Validate a mapped cache file and set up section pointers
+ * Returns 0 if the file is usable, 1 otherwise
+ */
+static int validate_map(CacheFile *file) {
+    const CacheHeader *header = file->map;
+
+    if (file->map_size < sizeof(CacheHeader)) return 1;
+    if (memcmp(header->magic, CACHE_MAGIC, sizeof(header->magic)) != 0) return 1;
+    if (header->version != CACHE_VERSION || header->header_size != sizeof(CacheHeader)) return 1;
+    if (header->table_size == 0 || (header->table_size & (header->table_size - 1)) != 0 ||
+        header->table_size / 2 < header->note_count) return 1;
+
+    uint64_t expected = sizeof(CacheHeader)
+                      + (uint64_t)header->note_count * sizeof(NoteRecord)
+                      + (uint64_t)header->table_size * sizeof(uint32_t)
+                      + (uint64_t)header->link_count * sizeof(CachedLink)
+                      + header->strings_size;
+    if (expected != file->map_size || header->strings_size == 0) return 1;
+
+    const char *body = (const char *)file->map + sizeof(CacheHeader);
+    if (fnv1a(body, file->map_size - sizeof(CacheHeader), FNV_OFFSET) != header->checksum) return 1;
+
+    file->notes = (const NoteRecord *)body;
+    file->note_count = header->note_count;
+    file->table = (const uint32_t *)(file->notes + header->note_count);
+    file->table_size = header->table_size;
+    file->links = (const CachedLink *)(file->table + header->table_size);
+    file->strings = (const char *)(file->links + header->link_count);
+
+    // Every string must be terminated inside the table
+    uint64_t strings_size = header->strings_size;
+    if (file->strings[strings_size - 1] != '\0') return 1;
+
+    for (uint32_t i = 0; i < header->note_count; i++) {
+        const NoteRecord *rec = &file->notes[i];
+        if ((rec->id != NO_STRING && rec->id >= strings_size) ||
+            (rec->title != NO_STRING && rec->title >= strings_size) ||
+            (rec->slug != NO_STRING && rec->slug >= strings_size)) return 1;
+        if ((uint64_t)rec->first_link + rec->link_count > header->link_count) return 1;
+    }
+    for (uint32_t i = 0; i < header->link_count; i++) {
+        if (file->links[i].text >= strings_size || file->links[i].url >= strings_size) return 1;
+    }
+    for (uint32_t i = 0; i < header->table_size; i++) {
+        if (file->table[i] > header->note_count) return 1;
+    }
+    return 0;
+}
+
+/**
+ * Map FRONTMATTER_CACHE_FILE into file
+ * Leaves file->map NULL if the file is missing or invalid
+ */
+static void load_file(CacheFile *file) {
+    memset(file, 0, sizeof(*file));
+
+    int fd = open(FRONTMATTER_CACHE_FILE, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        file->map_size = (size_t)st.st_size;
+        file->map = mmap(NULL, file->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (file->map == MAP_FAILED) {
+            memset(file, 0, sizeof(*file));
+        } else if (validate_map(file) != 0) {
+            // Corrupt or from another version - rebuild from scratch
+            munmap(file->map, file->map_size);
+            memset(file, 0, sizeof(*file));
+        }
+    }
+    close(fd);
+}
+
+static void unload_file(CacheFile *file) {
+    if (file->map != NULL) {
+        munmap(file->map, file->map_size);
+    }
+    memset(file, 0, sizeof(*file));
+}
+
+/**
+ * Find the record of a file identity in a loaded cache file
+ * Returns the record, or NULL if there is none
+ */
+static const NoteRecord* file_find(const CacheFile *file, uint64_t dev, uint64_t ino) {
+    if (file->map == NULL) {
+        return NULL;
+    }
+
+    uint32_t mask = file->table_size - 1;
+    uint32_t slot = (uint32_t)hash_key(dev, ino) & mask;
+    for (uint32_t probes = 0; probes < file->table_size; probes++) {
+        uint32_t index = file->table[slot];
+        if (index == 0) {
+            return NULL;
+        }
+        const NoteRecord *rec = &file->notes[index - 1];
+        if (rec->dev == dev && rec->ino == ino) {
+            return rec;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+static const char* view_string(const char *strings, uint32_t offset) {
+    return offset == NO_STRING ? NULL : strings + offset;
+}
+
+static void file_view(const CacheFile *file, const NoteRecord *rec, CachedNote *note) {
+    note->flags = rec->flags;
+    note->id = view_string(file->strings, rec->id);
+    note->title = view_string(file->strings, rec->title);
+    note->slug = view_string(file->strings, rec->slug);
+    note->strings = file->strings;
+    note->links = file->links + rec->first_link;
+    note->link_count = rec->link_count;
+}
+
+static void pending_view(const PendingNote *pending, CachedNote *note) {
+    const NoteRecord *rec = &pending->record;
+    note->flags = rec->flags;
+    note->id = view_string(pending->strings, rec->id);
+    note->title = view_string(pending->strings, rec->title);
+    note->slug = view_string(pending->strings, rec->slug);
+    note->strings = pending->strings;
+    note->links = pending->links;
+    note->link_count = rec->link_count;
+}
+
+/**
+ * Find the pending record of a file identity
+ * Returns the record, or NULL if there is none
+ */
+static PendingNote* pending_find(FrontmatterCache *cache, uint64_t dev, uint64_t ino) {
+    if (cache->pending_table_size == 0) {
+        return NULL;
+    }
+
+    size_t mask = cache->pending_table_size - 1;
+    size_t slot = hash_key(dev, ino) & mask;
+    while (cache->pending_table[slot] != 0) {
+        PendingNote *pending = &cache->pending[cache->pending_table[slot] - 1];
+        if (pending->record.dev == dev && pending->record.ino == ino) {
+            return pending;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+/**
+ * Insert pending record index into a table of the given size
+ */
+static void table_insert(uint32_t *table, size_t size, uint64_t hash, uint32_t index) {
+    size_t mask = size - 1;
+    size_t slot = hash & mask;
+    while (table[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    table[slot] = index + 1;
+}
+
+/**
+ * Add an empty pending record for a file identity
+ * Returns the record, or NULL on allocation failure
+ */
+static PendingNote* pending_add(FrontmatterCache *cache, const NoteKey *key) {
+    // Keep the table at most half full
+    if ((cache->pending_count + 1) * 2 > cache->pending_table_size) {
+        size_t new_size = cache->pending_table_size ? cache->pending_table_size * 2 : 1024;
+        uint32_t *table = calloc(new_size, sizeof(uint32_t));
+        if (table == NULL) return NULL;
+        for (size_t i = 0; i < cache->pending_count; i++) {
+            const NoteRecord *rec = &cache->pending[i].record;
+            table_insert(table, new_size, hash_key(rec->dev, rec->ino), (uint32_t)i);
+        }
+        free(cache->pending_table);
+        cache->pending_table = table;
+        cache->pending_table_size = new_size;
+    }
+
+    if (cache->pending_count == cache->pending_cap) {
+        size_t new_cap = cache->pending_cap ? cache->pending_cap * 2 : 256;
+        PendingNote *tmp = realloc(cache->pending, new_cap * sizeof(PendingNote));
+        if (tmp == NULL) return NULL;
+        cache->pending = tmp;
+        cache->pending_cap = new_cap;
+    }
+
+    PendingNote *pending = &cache->pending[cache->pending_count];
+    memset(pending, 0, sizeof(*pending));
+    pending->record.dev = key->dev;
+    pending->record.ino = key->ino;
+    table_insert(cache->pending_table, cache->pending_table_size,
+                 hash_key(key->dev, key->ino), (uint32_t)cache->pending_count);
+    cache->pending_count++;
+    return pending;
+}
+
+/**
+ * Copy a string of len bytes into a record's string block
+ * Returns its offset, or NO_STRING for NULL
+ */
+static uint32_t put_string(char *strings, size_t *used, const char *text, size_t len) {
+    if (text == NULL) {
+        return NO_STRING;
+    }
+    uint32_t offset = (uint32_t)*used;
+    memcpy(strings + *used, text, len);
+    strings[*used + len] = '\0';
+    *used += len + 1;
+    return offset;
+}
+
+/**
+ * Store the given parts of a note, replacing any pending record of the file
+ * flags selects the parts: CACHED_FIELDS (with CACHED_FRONTMATTER) uses
+ * fields, CACHED_LINKS uses texts and urls
+ * Caller holds the lock
+ */
+static void put_note(FrontmatterCache *cache, const NoteKey *key, uint32_t flags,
+                     const FrontmatterFields *fields, uint32_t link_count,
+                     const char *const *texts, const char *const *urls) {
+    size_t size = 0;
+    if (flags & CACHED_FIELDS) {
+        size += fields->id_len + fields->title_len + fields->slug_len + 3;
+    }
+    for (uint32_t i = 0; i < link_count; i++) {
+        size += strlen(texts[i]) + strlen(urls[i]) + 2;
+    }
+    if (size > UINT32_MAX - 1) {
+        return;
+    }
+
+    char *strings = malloc(size ? size : 1);
+    CachedLink *links = malloc((link_count ? link_count : 1) * sizeof(CachedLink));
+    if (strings == NULL || links == NULL) {
+        free(strings);
+        free(links);
+        return;
+    }
+
+    PendingNote *pending = pending_find(cache, key->dev, key->ino);
+    if (pending == NULL) {
+        pending = pending_add(cache, key);
+        if (pending == NULL) {
+            free(strings);
+            free(links);
+            return;
+        }
+    }
+    // The new parts may be copied from the old record: free it last
+    char *old_strings = pending->strings;
+    CachedLink *old_links = pending->links;
+
+    NoteRecord *rec = &pending->record;
+    rec->size = key->size;
+    rec->mtime_sec = key->mtime_sec;
+    rec->mtime_nsec = key->mtime_nsec;
+    rec->flags = flags;
+    rec->id = rec->title = rec->slug = NO_STRING;
+    rec->first_link = 0;
+    rec->link_count = link_count;
+
+    size_t used = 0;
+    if (flags & CACHED_FIELDS) {
+        rec->id = put_string(strings, &used, fields->id, fields->id_len);
+        rec->title = put_string(strings, &used, fields->title, fields->title_len);
+        rec->slug = put_string(strings, &used, fields->slug, fields->slug_len);
+    }
+    for (uint32_t i = 0; i < link_count; i++) {
+        links[i].text = put_string(strings, &used, texts[i], strlen(texts[i]));
+        links[i].url = put_string(strings, &used, urls[i], strlen(urls[i]));
+    }
+
+    pending->strings = strings;
+    pending->links = links;
+    free(old_strings);
+    free(old_links);
+}
+
+/**
+ * Current record of a file version, from this run or the loaded file
+ * Caller holds the lock
+ * Returns 0 and fills note if there is one, 1 otherwise
+ */
+static int find_note(FrontmatterCache *cache, const NoteKey *key, CachedNote *note) {
+    PendingNote *pending = pending_find(cache, key->dev, key->ino);
+    if (pending != NULL) {
+        if (!same_version(&pending->record, key)) return 1;
+        pending_view(pending, note);
+        return 0;
+    }
+
+    const NoteRecord *rec = file_find(&cache->file, key->dev, key->ino);
+    if (rec == NULL || !same_version(rec, key)) return 1;
+    file_view(&cache->file, rec, note);
+    return 0;
+}
+
+/**
+ * Check whether a file version may be stored
+ */
+static int storable(const FrontmatterCache *cache, const NoteKey *key) {
+    return cache != NULL && key->valid && key->mtime_sec + CACHE_RACY_SECONDS <= cache->started;
+}
+
+/**
+ * Load .jig/frontmatter.cache (missing, stale or corrupt files are ignored)
+ * Returns FrontmatterCache* or NULL on allocation failure
+ */
+FrontmatterCache* frontmatter_cache_open(void) {
+    FrontmatterCache *cache = calloc(1, sizeof(FrontmatterCache));
+    if (cache == NULL) {
+        fprintf(stderr, "Failed to allocate cache\n");
+        return NULL;
+    }
+
+    cache->started = time(NULL);
+    pthread_mutex_init(&cache->lock, NULL);
+    load_file(&cache->file);
+    return cache;
+}
+
+/**
+ * Stat path and look up its record
+ * Returns 0 on hit (note filled), 1 on miss
+ */
+int frontmatter_cache_lookup(FrontmatterCache *cache, const char *path, NoteKey *key,
+                             CachedNote *note) {
+    struct stat st;
+
+    memset(key, 0, sizeof(*key));
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return 1;
+    }
+    key->dev = (uint64_t)st.st_dev;
+    key->ino = (uint64_t)st.st_ino;
+    key->size = (uint64_t)st.st_size;
+    key->mtime_sec = (int64_t)st.st_mtim.tv_sec;
+    key->mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+    key->valid = 1;
+
+    pthread_mutex_lock(&cache->lock);
+    int result = find_note(cache, key, note);
+    pthread_mutex_unlock(&cache->lock);
+    return result;
+}
+
+/**
+ * Remember the frontmatter fields parsed from a file
+ */
+void frontmatter_cache_store_fields(FrontmatterCache *cache, const NoteKey *key,
+                                    int has_frontmatter, const FrontmatterFields *fields) {
+    if (!storable(cache, key)) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+
+    uint32_t flags = CACHED_FIELDS | (has_frontmatter ? CACHED_FRONTMATTER : 0);
+    CachedNote old;
+    const char **texts = NULL;
+    const char **urls = NULL;
+    uint32_t link_count = 0;
+
+    // Keep links stored by another command
+    if (find_note(cache, key, &old) == 0 && (old.flags & CACHED_LINKS)) {
+        texts = malloc((old.link_count ? old.link_count : 1) * sizeof(char*));
+        urls = malloc((old.link_count ? old.link_count : 1) * sizeof(char*));
+        if (texts != NULL && urls != NULL) {
+            for (uint32_t i = 0; i < old.link_count; i++) {
+                texts[i] = old.strings + old.links[i].text;
+                urls[i] = old.strings + old.links[i].url;
+            }
+            link_count = old.link_count;
+            flags |= CACHED_LINKS;
+        }
+    }
+
+    put_note(cache, key, flags, fields, link_count, texts, urls);
+
+    free(texts);
+    free(urls);
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/**
+ * Remember the markdown links parsed from a file
+ */
+void frontmatter_cache_store_links(FrontmatterCache *cache, const NoteKey *key, int count,
+                                   const char *const *texts, const char *const *urls) {
+    if (!storable(cache, key)) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+
+    uint32_t flags = CACHED_LINKS;
+    CachedNote old;
+    FrontmatterFields fields = {0};
+
+    // Keep fields stored by another command
+    if (find_note(cache, key, &old) == 0 && (old.flags & CACHED_FIELDS)) {
+        flags |= old.flags & (CACHED_FIELDS | CACHED_FRONTMATTER);
+        fields.id = old.id;
+        fields.id_len = old.id ? strlen(old.id) : 0;
+        fields.title = old.title;
+        fields.title_len = old.title ? strlen(old.title) : 0;
+        fields.slug = old.slug;
+        fields.slug_len = old.slug ? strlen(old.slug) : 0;
+    }
+
+    put_note(cache, key, flags, &fields, (uint32_t)count, texts, urls);
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/**
+ * Append a string to the output string table
+ * Returns its offset, NO_STRING for NULL, or -1 on failure
+ */
+static int64_t emit_string(Buffer *strings, const char *text) {
+    if (text == NULL) {
+        return NO_STRING;
+    }
+    int64_t offset = buffer_append(strings, text, strlen(text) + 1);
+    return offset >= NO_STRING ? -1 : offset;
+}
+
+/**
+ * Append one note to the output, taking each part from primary or,
+ * if primary lacks it, from secondary (may be NULL)
+ * Returns 0 on success, 1 on failure
+ */
+static int emit_note(Buffer *notes, Buffer *links, Buffer *strings, const NoteRecord *identity,
+                     const CachedNote *primary, const CachedNote *secondary) {
+    NoteRecord rec = *identity;
+    const CachedNote *fields_from = primary;
+    const CachedNote *links_from = primary;
+
+    if (secondary != NULL) {
+        if (!(primary->flags & CACHED_FIELDS) && (secondary->flags & CACHED_FIELDS)) {
+            fields_from = secondary;
+        }
+        if (!(primary->flags & CACHED_LINKS) && (secondary->flags & CACHED_LINKS)) {
+            links_from = secondary;
+        }
+    }
+
+    rec.flags = (fields_from->flags & (CACHED_FIELDS | CACHED_FRONTMATTER)) |
+                (links_from->flags & CACHED_LINKS);
+    rec.id = rec.title = rec.slug = NO_STRING;
+    rec.first_link = (uint32_t)(links->len / sizeof(CachedLink));
+    rec.link_count = 0;
+
+    if (rec.flags & CACHED_FIELDS) {
+        int64_t id = emit_string(strings, fields_from->id);
+        int64_t title = emit_string(strings, fields_from->title);
+        int64_t slug = emit_string(strings, fields_from->slug);
+        if (id < 0 || title < 0 || slug < 0) return 1;
+        rec.id = (uint32_t)id;
+        rec.title = (uint32_t)title;
+        rec.slug = (uint32_t)slug;
+    }
+
+    if (rec.flags & CACHED_LINKS) {
+        for (uint32_t i = 0; i < links_from->link_count; i++) {
+            int64_t text = emit_string(strings, links_from->strings + links_from->links[i].text);
+            int64_t url = emit_string(strings, links_from->strings + links_from->links[i].url);
+            if (text < 0 || url < 0) return 1;
+            CachedLink link = {(uint32_t)text, (uint32_t)url};
+            if (buffer_append(links, &link, sizeof(link)) < 0) return 1;
+        }
+        rec.link_count = links_from->link_count;
+    }
+
+    return buffer_append(notes, &rec, sizeof(rec)) < 0;
+}
+
+/**
+ * Write the cache file if anything was stored
+ * Returns 0 on success, 1 on error
+ */
+int frontmatter_cache_save(FrontmatterCache *cache) {
+    if (cache->pending_count == 0) {
+        return 0;
+    }
+
+    if (mkdir(FRONTMATTER_CACHE_DIR, 0755) == -1 && errno != EEXIST) {
+        fprintf(stderr, "Cannot create %s: %s\n", FRONTMATTER_CACHE_DIR, strerror(errno));
+        return 1;
+    }
+
+    // Pipeline stages save at about the same time: merge one after another
+    int lock_fd = open(CACHE_LOCK_FILE, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lock_fd == -1 || flock(lock_fd, LOCK_EX) != 0) {
+        fprintf(stderr, "Cannot lock %s: %s\n", CACHE_LOCK_FILE, strerror(errno));
+        if (lock_fd != -1) close(lock_fd);
+        return 1;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+
+    // Start from the current file, which may hold records from other commands
+    CacheFile current;
+    load_file(&current);
+
+    Buffer notes = {0};
+    Buffer links = {0};
+    Buffer strings = {0};
+    int failed = 0;
+
+    for (uint32_t i = 0; i < current.note_count && !failed; i++) {
+        const NoteRecord *rec = &current.notes[i];
+        if (pending_find(cache, rec->dev, rec->ino) != NULL) continue;
+
+        CachedNote note;
+        file_view(&current, rec, &note);
+        failed = emit_note(&notes, &links, &strings, rec, &note, NULL);
+    }
+
+    for (size_t i = 0; i < cache->pending_count && !failed; i++) {
+        const PendingNote *pending = &cache->pending[i];
+        CachedNote note;
+        CachedNote other;
+        const CachedNote *secondary = NULL;
+        NoteKey key = {
+            pending->record.dev, pending->record.ino, pending->record.size,
+            pending->record.mtime_sec, pending->record.mtime_nsec, 1
+        };
+
+        pending_view(pending, &note);
+        const NoteRecord *rec = file_find(&current, key.dev, key.ino);
+        if (rec != NULL && same_version(rec, &key)) {
+            file_view(&current, rec, &other);
+            secondary = &other;
+        }
+        failed = emit_note(&notes, &links, &strings, &pending->record, &note, secondary);
+    }
+
+    uint32_t note_count = (uint32_t)(notes.len / sizeof(NoteRecord));
+    uint32_t table_size = 1024;
+    while (table_size / 2 < note_count) table_size *= 2;
+    uint32_t *table = failed ? NULL : calloc(table_size, sizeof(uint32_t));
+
+    // Keep the string table non-empty so it always ends with a NUL
+    if (strings.len == 0 && buffer_append(&strings, "", 1) < 0) {
+        failed = 1;
+    }
+
+    int status = 1;
+    if (failed || table == NULL) {
+        fprintf(stderr, "Failed to build %s\n", FRONTMATTER_CACHE_FILE);
+    } else {
+        const NoteRecord *records = (const NoteRecord *)notes.data;
+        for (uint32_t i = 0; i < note_count; i++) {
+            table_insert(table, table_size, hash_key(records[i].dev, records[i].ino), i);
+        }
+
+        CacheHeader header = {0};
+        memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+        header.version = CACHE_VERSION;
+        header.header_size = sizeof(CacheHeader);
+        header.note_count = note_count;
+        header.table_size = table_size;
+        header.link_count = (uint32_t)(links.len / sizeof(CachedLink));
+        header.strings_size = strings.len;
+
+        uint64_t checksum = FNV_OFFSET;
+        checksum = fnv1a(notes.data, notes.len, checksum);
+        checksum = fnv1a(table, table_size * sizeof(uint32_t), checksum);
+        checksum = fnv1a(links.data, links.len, checksum);
+        checksum = fnv1a(strings.data, strings.len, checksum);
+        header.checksum = checksum;
+
+        // Write to a temporary file and rename, so readers never see a partial cache
+        char tmp_file[PATH_MAX];
+        snprintf(tmp_file, sizeof(tmp_file), "%s.%ld.tmp", FRONTMATTER_CACHE_FILE, (long)getpid());
+
+        FILE *fptr = fopen(tmp_file, "wb");
+        if (fptr == NULL) {
+            fprintf(stderr, "Cannot write cache %s: %s\n", tmp_file, strerror(errno));
+        } else {
+            int write_failed = fwrite(&header, sizeof(header), 1, fptr) != 1;
+            write_failed |= notes.len && fwrite(notes.data, notes.len, 1, fptr) != 1;
+            write_failed |= fwrite(table, table_size * sizeof(uint32_t), 1, fptr) != 1;
+            write_failed |= links.len && fwrite(links.data, links.len, 1, fptr) != 1;
+            write_failed |= fwrite(strings.data, strings.len, 1, fptr) != 1;
+            write_failed |= fclose(fptr) != 0;
+
+            if (write_failed || rename(tmp_file, FRONTMATTER_CACHE_FILE) != 0) {
+                fprintf(stderr, "Cannot write cache %s\n", FRONTMATTER_CACHE_FILE);
+                unlink(tmp_file);
+            } else {
+                status = 0;
+            }
+        }
+    }
+
+    free(table);
+    free(notes.data);
+    free(links.data);
+    free(strings.data);
+    unload_file(&current);
+    pthread_mutex_unlock(&cache->lock);
+    flock(lock_fd, LOCK_UN);
+    close(lock_fd);
+    return status;
+}
+
+/**
+ * Unmap cache file and free cache state
+ */
+void frontmatter_cache_close(FrontmatterCache *cache) {
+    if (cache == NULL) return;
+
+    unload_file(&cache->file);
+    for (size_t i = 0; i < cache->pending_count; i++) {
+        free(cache->pending[i].strings);
+        free(cache->pending[i].links);
+    }
+    free(cache->pending);
+    free(cache->pending_table);
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+}
@@ -0,0 +1,106 @@
+#ifndef FRONTMATTER_CACHE_H
+#define FRONTMATTER_CACHE_H
+
+#include <stdint.h>
+#include "frontmatter.h"
+
+#define FRONTMATTER_CACHE_DIR ".jig"
+#define FRONTMATTER_CACHE_FILE ".jig/frontmatter.cache"
+
+// CachedNote.flags
+#define CACHED_FIELDS        0x1   // has_frontmatter, id, title and slug are known
+#define CACHED_LINKS         0x2   // Markdown links of the whole file are known
+#define CACHED_FRONTMATTER   0x4   // File starts with frontmatter (with CACHED_FIELDS)
+
+/**
+ * Parsed-note cache shared by filter, nodes, edges, tree and hierarchy (--cache)
+ *
+ * Stored in .jig/frontmatter.cache as one mmap-able file:
+ *   header, note records, hash table on (dev, ino), links, string table
+ * A record is used only while the file's (dev, ino, size, mtime) still match,
+ * so an unchanged note costs one stat() instead of an open and a parse.
+ * Each command fills in the parts it parses; parts from other commands are kept.
+ * All functions may be called from several threads.
+ */
+typedef struct FrontmatterCache FrontmatterCache;
+
+/**
+ * Identity of a file version, taken by frontmatter_cache_lookup()
+ * valid is 0 if the file could not be stat'ed (nothing will be stored)
+ */
+typedef struct {
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t size;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    int valid;
+} NoteKey;
+
+/**
+ * Markdown link [text](url): offsets into CachedNote.strings
+ */
+typedef struct {
+    uint32_t text;
+    uint32_t url;
+} CachedLink;
+
+/**
+ * Cached view of one note; strings stay valid until the next store for
+ * the same file or frontmatter_cache_close()
+ *
+ * Fields:
+ *   flags          - CACHED_* parts present in the record
+ *   id/title/slug  - First field of that name, NULL if absent
+ *   strings, links - Link text and url are strings + links[i].text / .url
+ */
+typedef struct {
+    uint32_t flags;
+    const char *id;
+    const char *title;
+    const char *slug;
+    const char *strings;
+    const CachedLink *links;
+    uint32_t link_count;
+} CachedNote;
+
+/**
+ * Load .jig/frontmatter.cache (missing, stale or corrupt files are ignored)
+ * Returns FrontmatterCache* or NULL on allocation failure
+ */
+FrontmatterCache* frontmatter_cache_open(void);
+
+/**
+ * Stat path and look up its record
+ * key is filled in either case, for a later store
+ * Returns 0 on hit (note filled), 1 on miss
+ */
+int frontmatter_cache_lookup(FrontmatterCache *cache, const char *path, NoteKey *key,
+                             CachedNote *note);
+
+/**
+ * Remember the frontmatter fields parsed from a file
+ * has_frontmatter is 0 if the file does not start with frontmatter
+ */
+void frontmatter_cache_store_fields(FrontmatterCache *cache, const NoteKey *key,
+                                    int has_frontmatter, const FrontmatterFields *fields);
+
+/**
+ * Remember the markdown links parsed from a file
+ */
+void frontmatter_cache_store_links(FrontmatterCache *cache, const NoteKey *key, int count,
+                                   const char *const *texts, const char *const *urls);
+
+/**
+ * Write the cache file if anything was stored, merging with records
+ * written by other commands since it was loaded
+ * Returns 0 on success, 1 on error
+ */
+int frontmatter_cache_save(FrontmatterCache *cache);
+
+/**
+ * Unmap cache file and free cache state
+ */
+void frontmatter_cache_close(FrontmatterCache *cache);
+
+#endif /* FRONTMATTER_CACHE_H */
@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "frontmatter.h"
+#include "reader.h"
+
+/**
+ * Display help message for the frontmatter CLI tool.
+ */
+static void help(void) {
+    printf("Usage: jig-frontmatter [OPTIONS] FILE\n");
+    printf("\n");
+    printf("Print the YAML frontmatter fields of a note, one per line.\n");
+    printf("\n");
+    printf("Options:\n");
+    printf("  -h, --help          Display this help and exit\n");
+    printf("\n");
+    printf("Output Format:\n");
+    printf("  key: value          Top-level field (quotes removed)\n");
+    printf("    - value           Item of the preceding list (e.g. links)\n");
+    printf("\n");
+    printf("Examples:\n");
+    printf("  jig-frontmatter datasets/basic/father/index.en.md\n");
+}
+
+/**
+ * Standalone executable for inspecting frontmatter.
+ * Build with: make (from src/frontmatter directory)
+ */
+int main(int argc, char **argv) {
+    // Handle help flag
+    if (argc == 2 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)) {
+        help();
+        return 0;
+    }
+
+    // Require exactly one argument
+    if (argc != 2) {
+        fprintf(stderr, "Error: exactly one FILE argument required\n");
+        fprintf(stderr, "Use -h or --help for usage information\n");
+        return 1;
+    }
+
+    FileView view;
+    if (file_view_open(&view, argv[1]) != 0) {
+        fprintf(stderr, "Error: Cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    FrontmatterLexer lexer;
+    FrontmatterEntry entry;
+    if (frontmatter_begin(&lexer, view.data, view.len) != 0) {
+        fprintf(stderr, "Error: %s has no frontmatter\n", argv[1]);
+        file_view_close(&view);
+        return 1;
+    }
+
+    while (frontmatter_next(&lexer, &entry)) {
+        if (entry.kind == FRONTMATTER_ITEM) {
+            printf("  - %.*s\n", (int)entry.value_len, entry.value);
+        } else if (entry.value_len == 0) {
+            printf("%.*s:\n", (int)entry.key_len, entry.key);
+        } else {
+            printf("%.*s: %.*s\n", (int)entry.key_len, entry.key,
+                   (int)entry.value_len, entry.value);
+        }
+    }
+
+    file_view_close(&view);
+    return 0;
+}
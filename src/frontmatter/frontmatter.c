@@ -0,0 +1,185 @@
+#include <string.h>
+#include "frontmatter.h"
+
+static int is_blank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+/**
+ * Check for a "---" or "..." document marker line (already right-trimmed)
+ */
+static int is_marker(const char *line, const char *end) {
+    return end - line == 3 &&
+           (memcmp(line, "---", 3) == 0 || memcmp(line, "...", 3) == 0);
+}
+
+/**
+ * Remove surrounding blanks and one level of matching quotes
+ */
+static void set_value(FrontmatterEntry *entry, const char *start, const char *end) {
+    while (start < end && is_blank(*start)) start++;
+    while (end > start && is_blank(end[-1])) end--;
+
+    if (end - start >= 2 && (*start == '"' || *start == '\'') && end[-1] == *start) {
+        start++;
+        end--;
+    }
+
+    entry->value = start;
+    entry->value_len = end - start;
+}
+
+/**
+ * Start lexing a file's frontmatter
+ * Returns 0 if frontmatter is present, 1 otherwise
+ */
+int frontmatter_begin(FrontmatterLexer *lexer, const char *data, size_t len) {
+    memset(lexer, 0, sizeof(*lexer));
+    lexer->data = data;
+    lexer->len = len;
+
+    if (len < 3 || memcmp(data, "---", 3) != 0) {
+        return 1;
+    }
+
+    const char *p = data + 3;
+    const char *limit = data + len;
+    while (p < limit && (is_blank(*p) || *p == '\r')) p++;
+    if (p < limit && *p != '\n') {
+        return 1;
+    }
+
+    lexer->pos = p < limit ? (size_t)(p - data) + 1 : len;
+    return 0;
+}
+
+/**
+ * Read the next entry, scanning each line once
+ * Returns 1 if entry was filled, 0 at the closing "---" or end of data
+ */
+int frontmatter_next(FrontmatterLexer *lexer, FrontmatterEntry *entry) {
+    const char *limit = lexer->data + lexer->len;
+
+    while (!lexer->closed && lexer->pos < lexer->len) {
+        const char *line = lexer->data + lexer->pos;
+        const char *newline = memchr(line, '\n', limit - line);
+        const char *end = newline ? newline : limit;
+        lexer->pos = newline ? (size_t)(newline - lexer->data) + 1 : lexer->len;
+
+        while (end > line && (is_blank(end[-1]) || end[-1] == '\r')) end--;
+
+        if (is_marker(line, end)) {
+            lexer->closed = 1;
+            break;
+        }
+
+        const char *p = line;
+        while (p < end && is_blank(*p)) p++;
+        if (p == end || *p == '#') {
+            continue;
+        }
+
+        // "- value" belongs to the last key that had no inline value
+        if (*p == '-' && (p + 1 == end || is_blank(p[1]))) {
+            if (lexer->list_key == NULL) {
+                continue;
+            }
+            entry->kind = FRONTMATTER_ITEM;
+            entry->key = lexer->list_key;
+            entry->key_len = lexer->list_key_len;
+            set_value(entry, p + 1, end);
+            return 1;
+        }
+
+        // Indented lines are nested mappings or continuations: not ours
+        if (p != line) {
+            continue;
+        }
+
+        // Key ends at the first ":" followed by a blank or the end of line
+        const char *colon = p;
+        while (colon < end && !(*colon == ':' && (colon + 1 == end || is_blank(colon[1])))) {
+            colon++;
+        }
+        lexer->list_key = NULL;
+        if (colon == end) {
+            continue;
+        }
+
+        const char *key_end = colon;
+        while (key_end > p && is_blank(key_end[-1])) key_end--;
+
+        entry->kind = FRONTMATTER_FIELD;
+        entry->key = p;
+        entry->key_len = key_end - p;
+        set_value(entry, colon + 1, end);
+
+        if (entry->value_len == 0 && colon + 1 >= end) {
+            lexer->list_key = entry->key;
+            lexer->list_key_len = entry->key_len;
+        }
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Check whether an entry's key equals key (case-sensitive, like YAML)
+ */
+int frontmatter_key_is(const FrontmatterEntry *entry, const char *key) {
+    size_t len = strlen(key);
+    return entry->key_len == len && memcmp(entry->key, key, len) == 0;
+}
+
+/**
+ * Collect the first id, title and slug fields of a file's frontmatter
+ * Returns 0 if data starts with frontmatter, 1 otherwise
+ */
+int frontmatter_fields(const char *data, size_t len, FrontmatterFields *fields) {
+    return frontmatter_fields_keys(data, len, fields, NULL, 0, NULL);
+}
+
+/**
+ * Collect the first id, title and slug fields and the first value of each
+ * of count keys, in one scan of the frontmatter
+ * Returns 0 if data starts with frontmatter, 1 otherwise
+ */
+int frontmatter_fields_keys(const char *data, size_t len, FrontmatterFields *fields,
+                            const char *const *keys, int count, FrontmatterValue *values) {
+    FrontmatterLexer lexer;
+    FrontmatterEntry entry;
+
+    memset(fields, 0, sizeof(*fields));
+    for (int i = 0; i < count; i++) {
+        values[i].value = NULL;
+        values[i].len = 0;
+    }
+    if (frontmatter_begin(&lexer, data, len) != 0) {
+        return 1;
+    }
+
+    while (frontmatter_next(&lexer, &entry)) {
+        if (entry.kind != FRONTMATTER_FIELD) continue;
+
+        if (fields->id == NULL && frontmatter_key_is(&entry, "id")) {
+            fields->id = entry.value;
+            fields->id_len = entry.value_len;
+        } else if (fields->title == NULL && frontmatter_key_is(&entry, "title")) {
+            fields->title = entry.value;
+            fields->title_len = entry.value_len;
+        } else if (fields->slug == NULL && frontmatter_key_is(&entry, "slug")) {
+            fields->slug = entry.value;
+            fields->slug_len = entry.value_len;
+        }
+
+        // Requested keys may repeat id, title or slug
+        for (int i = 0; i < count; i++) {
+            if (values[i].value == NULL && frontmatter_key_is(&entry, keys[i])) {
+                values[i].value = entry.value;
+                values[i].len = entry.value_len;
+            }
+        }
+    }
+    return 0;
+}
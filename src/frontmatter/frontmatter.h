@@ -0,0 +1,115 @@
+#ifndef FRONTMATTER_H
+#define FRONTMATTER_H
+
+#include <stddef.h>
+
+/**
+ * Kind of entry returned by frontmatter_next()
+ *
+ *   FRONTMATTER_FIELD - Top-level "key: value" line
+ *   FRONTMATTER_ITEM  - "- value" line of a block list; key is the list's key
+ *                       (e.g. each entry under "links:")
+ */
+typedef enum {
+    FRONTMATTER_FIELD,
+    FRONTMATTER_ITEM
+} FrontmatterKind;
+
+/**
+ * One key/value pair of the frontmatter
+ *
+ * key and value point into the buffer given to frontmatter_begin() and are
+ * not NUL-terminated. Values have surrounding whitespace removed and one
+ * level of matching "..." or '...' quotes stripped; escapes are left as-is.
+ */
+typedef struct {
+    FrontmatterKind kind;
+    const char *key;
+    size_t key_len;
+    const char *value;
+    size_t value_len;
+} FrontmatterEntry;
+
+/**
+ * Lexer state for one file (no allocation, nothing to free)
+ *
+ * Fields:
+ *   data, len     - File content
+ *   pos           - Start of the next line to scan
+ *   list_key      - Key of the block list being read (NULL outside a list)
+ *   closed        - Closing "---" has been reached
+ */
+typedef struct {
+    const char *data;
+    size_t len;
+    size_t pos;
+    const char *list_key;
+    size_t list_key_len;
+    int closed;
+} FrontmatterLexer;
+
+/**
+ * First id, title and slug fields of a file (slices into the file content)
+ * A field that is absent has a NULL pointer
+ */
+typedef struct {
+    const char *id;
+    size_t id_len;
+    const char *title;
+    size_t title_len;
+    const char *slug;
+    size_t slug_len;
+} FrontmatterFields;
+
+/**
+ * Value of a key looked up by frontmatter_fields_keys() (slice into the
+ * file content, NULL if the key is absent)
+ */
+typedef struct {
+    const char *value;
+    size_t len;
+} FrontmatterValue;
+
+/**
+ * Start lexing a file's frontmatter
+ * The first line must be "---" (trailing whitespace allowed)
+ * Returns 0 if frontmatter is present, 1 otherwise
+ *
+ * Example usage:
+ *   FrontmatterLexer lexer;
+ *   FrontmatterEntry entry;
+ *   if (frontmatter_begin(&lexer, content, size) == 0) {
+ *       while (frontmatter_next(&lexer, &entry)) {
+ *           if (frontmatter_key_is(&entry, "title")) { ... }
+ *       }
+ *   }
+ */
+int frontmatter_begin(FrontmatterLexer *lexer, const char *data, size_t len);
+
+/**
+ * Read the next entry, scanning each line once
+ * Nested mappings, comments and blank lines are skipped
+ * Returns 1 if entry was filled, 0 at the closing "---" or end of data
+ */
+int frontmatter_next(FrontmatterLexer *lexer, FrontmatterEntry *entry);
+
+/**
+ * Check whether an entry's key equals key (case-sensitive, like YAML)
+ */
+int frontmatter_key_is(const FrontmatterEntry *entry, const char *key);
+
+/**
+ * Collect the first id, title and slug fields of a file's frontmatter
+ * Returns 0 if data starts with frontmatter, 1 otherwise (fields all NULL)
+ */
+int frontmatter_fields(const char *data, size_t len, FrontmatterFields *fields);
+
+/**
+ * Collect the first id, title and slug fields and, in the same scan, the
+ * first value of each of count keys into values[0..count)
+ * Returns 0 if data starts with frontmatter, 1 otherwise (all NULL)
+ */
+int frontmatter_fields_keys(const char *data, size_t len, FrontmatterFields *fields,
+                            const char *const *keys, int count, FrontmatterValue *values);
+
+#endif /* FRONTMATTER_H */
@@ -0,0 +1,115 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "reader.h"
+
+// One FILE_VIEW_MMAP_THRESHOLD buffer per thread, freed when the thread exits
+static pthread_key_t buffer_key;
+static pthread_once_t buffer_once = PTHREAD_ONCE_INIT;
+static int buffer_key_ok;
+
+static void create_buffer_key(void) {
+    buffer_key_ok = pthread_key_create(&buffer_key, free) == 0;
+}
+
+/**
+ * Get the calling thread's read buffer, allocating it on first use
+ * Returns the buffer, or NULL on allocation failure
+ */
+static char* thread_buffer(void) {
+    pthread_once(&buffer_once, create_buffer_key);
+    if (!buffer_key_ok) {
+        return NULL;
+    }
+
+    char *buffer = pthread_getspecific(buffer_key);
+    if (buffer == NULL) {
+        buffer = malloc(FILE_VIEW_MMAP_THRESHOLD);
+        if (buffer != NULL && pthread_setspecific(buffer_key, buffer) != 0) {
+            free(buffer);
+            buffer = NULL;
+        }
+    }
+    return buffer;
+}
+
+/**
+ * Read up to cap bytes of fd into buffer
+ * Returns number of bytes read, or -1 on error
+ */
+static ssize_t read_all(int fd, char *buffer, size_t cap) {
+    size_t len = 0;
+
+    while (len < cap) {
+        ssize_t n = read(fd, buffer + len, cap - len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        len += n;
+    }
+    return (ssize_t)len;
+}
+
+/**
+ * Open a view of a file's content
+ * Returns 0 on success, 1 if the file cannot be opened or read
+ */
+int file_view_open(FileView *view, const char *path) {
+    struct stat st;
+
+    memset(view, 0, sizeof(*view));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return 1;
+    }
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return 1;
+    }
+
+    if (S_ISREG(st.st_mode) && st.st_size >= FILE_VIEW_MMAP_THRESHOLD) {
+        void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            return 1;
+        }
+        madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+        view->data = map;
+        view->len = (size_t)st.st_size;
+        view->map = map;
+        return 0;
+    }
+
+    // A small file that grows while being read is cut at the buffer size
+    char *buffer = thread_buffer();
+    ssize_t len = buffer != NULL ? read_all(fd, buffer, FILE_VIEW_MMAP_THRESHOLD) : -1;
+    close(fd);
+    if (len < 0) {
+        return 1;
+    }
+
+    view->data = buffer;
+    view->len = (size_t)len;
+    return 0;
+}
+
+/**
+ * Release a view (unmaps large files; small-file buffers are kept)
+ */
+void file_view_close(FileView *view) {
+    if (view->map != NULL) {
+        munmap(view->map, view->len);
+    }
+    memset(view, 0, sizeof(*view));
+}
@@ -0,0 +1,45 @@
+#ifndef FRONTMATTER_READER_H
+#define FRONTMATTER_READER_H
+
+#include <stddef.h>
+
+// Files of at least this size are memory-mapped instead of read
+#define FILE_VIEW_MMAP_THRESHOLD (64 * 1024)
+
+/**
+ * Read-only view of a whole file's content (not NUL-terminated)
+ *
+ * Fields:
+ *   data, len - File content
+ *   map       - Mapped region to unmap on close, NULL if data is the
+ *               calling thread's read buffer
+ */
+typedef struct {
+    const char *data;
+    size_t len;
+    void *map;
+} FileView;
+
+/**
+ * Open a view of a file's content
+ * Small files are read into a buffer owned by the calling thread and reused
+ * for its next view, so a thread holds one small-file view at a time;
+ * larger files are mapped with MADV_SEQUENTIAL, so pages that are never
+ * touched are never read
+ * Returns 0 on success, 1 if the file cannot be opened or read
+ *
+ * Example usage:
+ *   FileView view;
+ *   if (file_view_open(&view, path) == 0) {
+ *       parse(view.data, view.len);
+ *       file_view_close(&view);
+ *   }
+ */
+int file_view_open(FileView *view, const char *path);
+
+/**
+ * Release a view (unmaps large files; small-file buffers are kept)
+ */
+void file_view_close(FileView *view);
+
+#endif /* FRONTMATTER_READER_H */
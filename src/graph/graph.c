@@ -0,0 +1,265 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "graph.h"
+#include "alloc/alloc.h"
+
+/**
+ * Size of a string in the string table (0 for an absent value)
+ */
+static size_t string_size(const char *s) {
+    return s != NULL ? strlen(s) + 1 : 0;
+}
+
+/**
+ * Assign the next string table offset to s
+ * Returns the offset, or GRAPH_NONE for an absent value
+ */
+static uint32_t next_offset(const char *s, uint64_t *offset) {
+    if (s == NULL) {
+        return GRAPH_NONE;
+    }
+    uint32_t current = (uint32_t)*offset;
+    *offset += strlen(s) + 1;
+    return current;
+}
+
+/**
+ * Check whether a stream starts with a binary graph, without consuming it
+ * Returns 1 for a binary stream, 0 for text (paths or CSV) or empty input
+ */
+int graph_is_binary(FILE *in) {
+    int c = getc(in);
+    if (c == EOF) {
+        return 0;
+    }
+    ungetc(c, in);
+    return c == (unsigned char)GRAPH_MAGIC[0];
+}
+
+/**
+ * Write nodes, and edges if not NULL, as a binary stream
+ * Strings are written in record order: id, title, path of each node,
+ * then each distinct edge label once, shared by all edges with that label
+ * Returns 0 on success, 1 on error
+ */
+int graph_write(FILE *out, const NodeList *nodes, const EdgeList *edges) {
+    GraphHeader header = {0};
+    uint64_t strings_size = 0;
+    const StringTable *labels = edges != NULL ? &edges->labels : NULL;
+
+    // Size the string table first; the header comes before it
+    for (int i = 0; i < nodes->count; i++) {
+        const Node *node = &nodes->items[i];
+        strings_size += string_size(node->id) + string_size(node->title) +
+                        string_size(node->path);
+    }
+    for (int i = 0; labels != NULL && i < labels->count; i++) {
+        strings_size += string_size(labels->strings[i]);
+    }
+    if (strings_size >= GRAPH_NONE) {
+        fprintf(stderr, "Error: Too much text for binary output\n");
+        return 1;
+    }
+
+    memcpy(header.magic, GRAPH_MAGIC, GRAPH_MAGIC_LEN);
+    header.version = GRAPH_VERSION;
+    header.flags = edges != NULL ? GRAPH_HAS_EDGES : 0;
+    header.node_count = (uint32_t)nodes->count;
+    header.edge_count = edges != NULL ? (uint32_t)edges->count : 0;
+    header.strings_size = (uint32_t)strings_size;
+    fwrite(&header, sizeof(header), 1, out);
+
+    // Records, with offsets assigned in the order the strings follow
+    uint64_t offset = 0;
+    for (int i = 0; i < nodes->count; i++) {
+        const Node *node = &nodes->items[i];
+        GraphNode record;
+        record.id = next_offset(node->id, &offset);
+        record.title = next_offset(node->title, &offset);
+        record.path = next_offset(node->path, &offset);
+        fwrite(&record, sizeof(record), 1, out);
+    }
+
+    // Label offsets by label id
+    uint32_t *label_offsets = NULL;
+    if (labels != NULL && labels->count > 0) {
+        label_offsets = malloc((size_t)labels->count * sizeof(uint32_t));
+        if (label_offsets == NULL) {
+            fprintf(stderr, "Failed to allocate memory for binary output\n");
+            return 1;
+        }
+        for (int i = 0; i < labels->count; i++) {
+            label_offsets[i] = next_offset(labels->strings[i], &offset);
+        }
+    }
+    for (int i = 0; edges != NULL && i < edges->count; i++) {
+        const Edge *edge = &edges->items[i];
+        GraphEdge record;
+        record.src = (uint32_t)(edge->src - nodes->items);
+        record.dst = (uint32_t)(edge->dst - nodes->items);
+        record.label = label_offsets[edge->label];
+        fwrite(&record, sizeof(record), 1, out);
+    }
+    free(label_offsets);
+
+    // String table
+    for (int i = 0; i < nodes->count; i++) {
+        const Node *node = &nodes->items[i];
+        fwrite(node->id, 1, string_size(node->id), out);
+        if (node->title != NULL) fwrite(node->title, 1, string_size(node->title), out);
+        if (node->path != NULL) fwrite(node->path, 1, string_size(node->path), out);
+    }
+    for (int i = 0; labels != NULL && i < labels->count; i++) {
+        fwrite(labels->strings[i], 1, string_size(labels->strings[i]), out);
+    }
+
+    if (ferror(out)) {
+        fprintf(stderr, "Error: Failed to write binary output\n");
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Resolve a string table offset
+ * Returns 0 and sets *s (NULL for GRAPH_NONE), or 1 if offset is out of range
+ */
+static int resolve_string(const char *strings, uint32_t strings_size, uint32_t offset,
+                          char **s) {
+    if (offset == GRAPH_NONE) {
+        *s = NULL;
+        return 0;
+    }
+    if (offset >= strings_size) {
+        return 1;
+    }
+    *s = (char*)strings + offset;
+    return 0;
+}
+
+/**
+ * Read a binary stream written by graph_write()
+ * Returns 0 on success, 1 on error (message printed)
+ */
+int graph_read(FILE *in, NodeList **nodes_out, EdgeList **edges_out) {
+    GraphHeader header;
+
+    *nodes_out = NULL;
+    if (edges_out != NULL) {
+        *edges_out = NULL;
+    }
+
+    if (fread(&header, sizeof(header), 1, in) != 1 ||
+        memcmp(header.magic, GRAPH_MAGIC, GRAPH_MAGIC_LEN) != 0) {
+        fprintf(stderr, "Error: Invalid binary input\n");
+        return 1;
+    }
+    if (header.version != GRAPH_VERSION) {
+        fprintf(stderr, "Error: Unsupported binary input version %u\n", header.version);
+        return 1;
+    }
+    if (header.node_count > INT32_MAX || header.edge_count > INT32_MAX) {
+        fprintf(stderr, "Error: Invalid binary input\n");
+        return 1;
+    }
+
+    uint32_t edge_count = (header.flags & GRAPH_HAS_EDGES) ? header.edge_count : 0;
+    uint64_t node_bytes = (uint64_t)header.node_count * sizeof(GraphNode);
+    uint64_t edge_bytes = (uint64_t)edge_count * sizeof(GraphEdge);
+    uint64_t body_size = node_bytes + edge_bytes + header.strings_size;
+    if (body_size >= SIZE_MAX) {
+        fprintf(stderr, "Error: Binary input too large\n");
+        return 1;
+    }
+
+    NodeList *nodes = calloc(1, sizeof(NodeList));
+    if (nodes == NULL ||
+        vector_reserve((void**)&nodes->items, &nodes->cap, (int)header.node_count,
+                       sizeof(Node)) != 0) {
+        fprintf(stderr, "Failed to allocate NodeList\n");
+        free(nodes);
+        return 1;
+    }
+
+    // The whole body is read into the arena in one go; strings stay there
+    // (one spare byte, so an empty stream still gets a buffer)
+    char *body = arena_alloc(&nodes->arena, (size_t)body_size + 1);
+    if (body == NULL) {
+        fprintf(stderr, "Failed to allocate memory for binary input\n");
+        free_nodes(nodes);
+        return 1;
+    }
+    if (fread(body, 1, (size_t)body_size, in) != (size_t)body_size) {
+        fprintf(stderr, "Error: Truncated binary input\n");
+        free_nodes(nodes);
+        return 1;
+    }
+
+    const char *strings = body + node_bytes + edge_bytes;
+    uint32_t strings_size = header.strings_size;
+    if (strings_size > 0 && strings[strings_size - 1] != '\0') {
+        fprintf(stderr, "Error: Invalid binary input\n");
+        free_nodes(nodes);
+        return 1;
+    }
+
+    // arena_alloc() aligns the body, so records are used in place
+    const GraphNode *node_records = (const GraphNode*)body;
+    for (uint32_t i = 0; i < header.node_count; i++) {
+        const GraphNode *record = &node_records[i];
+        Node *node = &nodes->items[i];
+        char *id;
+
+        if (resolve_string(strings, strings_size, record->id, &id) != 0 ||
+            resolve_string(strings, strings_size, record->title, &node->title) != 0 ||
+            resolve_string(strings, strings_size, record->path, &node->path) != 0 ||
+            id == NULL || strlen(id) > 36) {
+            fprintf(stderr, "Error: Invalid binary input\n");
+            free_nodes(nodes);
+            return 1;
+        }
+        memcpy(node->id, id, strlen(id) + 1);
+        node->values = NULL;
+        nodes->count++;
+    }
+
+    if (edges_out != NULL && (header.flags & GRAPH_HAS_EDGES)) {
+        EdgeList *edges = calloc(1, sizeof(EdgeList));
+        if (edges == NULL ||
+            vector_reserve((void**)&edges->items, &edges->cap, (int)edge_count,
+                           sizeof(Edge)) != 0) {
+            fprintf(stderr, "Failed to allocate EdgeList\n");
+            free(edges);
+            free_nodes(nodes);
+            return 1;
+        }
+
+        // Labels are interned again, so edges that share a label share its id
+        const GraphEdge *edge_records = (const GraphEdge*)(body + node_bytes);
+        for (uint32_t i = 0; i < edge_count; i++) {
+            const GraphEdge *record = &edge_records[i];
+            Edge *edge = &edges->items[i];
+            char *label;
+
+            if (record->src >= header.node_count || record->dst >= header.node_count ||
+                resolve_string(strings, strings_size, record->label, &label) != 0 ||
+                label == NULL || (edge->label = intern(&edges->labels, label)) < 0) {
+                fprintf(stderr, "Error: Invalid binary input\n");
+                free(edges->items);
+                intern_release(&edges->labels);
+                free(edges);
+                free_nodes(nodes);
+                return 1;
+            }
+            edge->src = &nodes->items[record->src];
+            edge->dst = &nodes->items[record->dst];
+            edges->count++;
+        }
+        *edges_out = edges;
+    }
+
+    *nodes_out = nodes;
+    return 0;
+}
@@ -0,0 +1,76 @@
+#ifndef GRAPH_GRAPH_H
+#define GRAPH_GRAPH_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "nodes/nodes.h"
+#include "edges/edges.h"
+
+// First bytes of a binary stream; 0x89 never starts a path or a CSV header
+#define GRAPH_MAGIC "\x89JIGRPH\n"
+#define GRAPH_MAGIC_LEN 8
+#define GRAPH_VERSION 1
+
+// GraphHeader.flags
+#define GRAPH_HAS_EDGES 0x1   // Edge records follow the node records
+
+// String offset of an absent value (Node.title, Node.path)
+#define GRAPH_NONE UINT32_MAX
+
+/**
+ * Binary node/edge stream (--format bin), written and read in host byte order
+ *
+ * Layout:
+ *   GraphHeader
+ *   GraphNode[node_count]
+ *   GraphEdge[edge_count]      (only with GRAPH_HAS_EDGES)
+ *   strings[strings_size]      NUL-terminated strings
+ * Strings are referenced by their offset in the string table, nodes by
+ * their index, so a stage loads its input with one read and no parsing.
+ */
+typedef struct {
+    char magic[GRAPH_MAGIC_LEN];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t node_count;
+    uint32_t edge_count;
+    uint32_t strings_size;
+    uint32_t reserved;
+} GraphHeader;
+
+typedef struct {
+    uint32_t id;
+    uint32_t title;
+    uint32_t path;
+} GraphNode;
+
+typedef struct {
+    uint32_t src;
+    uint32_t dst;
+    uint32_t label;
+} GraphEdge;
+
+/**
+ * Check whether a stream starts with a binary graph, without consuming it
+ * Returns 1 for a binary stream, 0 for text (paths or CSV) or empty input
+ */
+int graph_is_binary(FILE *in);
+
+/**
+ * Write nodes, and edges if not NULL, as a binary stream
+ * Edges must point into nodes->items
+ * Returns 0 on success, 1 on error
+ */
+int graph_write(FILE *out, const NodeList *nodes, const EdgeList *edges);
+
+/**
+ * Read a binary stream written by graph_write()
+ * The string table is loaded into the node list's arena; node titles and
+ * paths and edge labels point into it, so edges live only as long as nodes.
+ * With edges NULL the edge records are skipped; *edges is set to NULL
+ * when the stream has none.
+ * Returns 0 on success, 1 on error (message printed)
+ */
+int graph_read(FILE *in, NodeList **nodes, EdgeList **edges);
+
+#endif /* GRAPH_GRAPH_H */
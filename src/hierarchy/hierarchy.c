@@ -2,12 +2,15 @@
 #include <string.h>
 #include <stdlib.h>
 #include <limits.h>
-#include <regex.h>
 
 #include "hierarchy.h"
 #include "nodes/nodes.h"
 #include "edges/edges.h"
+#include "graph/graph.h"
 #include "slugify/slugify.h"
+#include "frontmatter/frontmatter.h"
+#include "frontmatter/cache.h"
+#include "frontmatter/reader.h"
 
 /**
  * Display help message
@@ -20,10 +23,14 @@ static void help(void) {
     printf("\n");
     printf("Reads file paths from stdin and outputs YAML format suitable for Hugo's\n");
     printf("data/ directory. The output maps each note's slug to an ordered list of\n");
-    printf("ancestor slugs (from immediate parent to root).\n");
+    printf("ancestor slugs (from immediate parent to root). A jig nodes/edges\n");
+    printf("--format bin stream is accepted instead of paths.\n");
     printf("\n");
     printf("Options:\n");
     printf("  -h, --help          Display this help and exit\n");
+    printf("  -0, --null          Read NUL-separated paths (from jig find -0)\n");
+    printf("      --cache         Reuse notes parsed by earlier runs (%s)\n",
+           FRONTMATTER_CACHE_FILE);
     printf("\n");
     printf("Output Format:\n");
     printf("  YAML with structure:\n");
@@ -68,69 +75,73 @@ static char* extract_folder_name(const char *filepath) {
     return folder;
 }
 
+/**
+ * Copy a slug value; an empty slug counts as absent
+ * Returns allocated string or NULL
+ */
+static char* copy_slug(const char *value, size_t len) {
+    if (value == NULL || len == 0) return NULL;
+
+    char *slug = malloc(len + 1);
+    if (slug != NULL) {
+        memcpy(slug, value, len);
+        slug[len] = '\0';
+    }
+    return slug;
+}
+
 /**
  * Parse slug field from file's frontmatter
+ * With cache, unchanged files are not read again
  * Returns allocated string or NULL if not found
  */
-static char* parse_slug_from_file(const char *filepath) {
-    FILE *fptr = fopen(filepath, "r");
-    if (fptr == NULL) return NULL;
-
-    fseek(fptr, 0L, SEEK_END);
-    long filesize = ftell(fptr);
-    fseek(fptr, 0L, SEEK_SET);
-
-    char *content = malloc(filesize + 1);
-    if (content == NULL) {
-        fclose(fptr);
-        return NULL;
+static char* parse_slug_from_file(const char *filepath, FrontmatterCache *cache) {
+    NoteKey key;
+    CachedNote note;
+
+    if (cache != NULL &&
+        frontmatter_cache_lookup(cache, filepath, &key, &note) == 0 &&
+        (note.flags & CACHED_FIELDS)) {
+        return copy_slug(note.slug, note.slug ? strlen(note.slug) : 0);
     }
 
-    fread(content, 1, filesize, fptr);
-    content[filesize] = '\0';
-    fclose(fptr);
+    FileView view;
+    if (file_view_open(&view, filepath) != 0) return NULL;
 
-    // Find slug field using regex
-    regex_t rgx;
-    regmatch_t matches[2];
-    char *pattern = "^slug: (.*)$";
+    // An empty slug falls back to the folder name
+    FrontmatterFields fields;
+    int has_frontmatter = frontmatter_fields(view.data, view.len, &fields) == 0;
+    char *slug = copy_slug(fields.slug, fields.slug_len);
 
-    if (regcomp(&rgx, pattern, REG_EXTENDED | REG_NEWLINE) != 0) {
-        free(content);
-        return NULL;
+    if (cache != NULL) {
+        frontmatter_cache_store_fields(cache, &key, has_frontmatter, &fields);
     }
 
-    char *slug = NULL;
-    if (regexec(&rgx, content, 2, matches, 0) == 0) {
-        int start = matches[1].rm_so;
-        int end = matches[1].rm_eo;
-        int len = end - start;
-
-        slug = malloc(len + 1);
-        if (slug != NULL) {
-            strncpy(slug, content + start, len);
-            slug[len] = '\0';
-        }
-    }
-
-    regfree(&rgx);
-    free(content);
+    file_view_close(&view);
     return slug;
 }
 
 /**
  * Get slug for a node
  * First checks for slug in frontmatter, falls back to folder name
+ * The slug parsed with the node (node->values[0]) is used when present;
+ * nodes from a binary stream carry none, so their file is read
  */
-static char* get_node_slug(const char *filepath) {
+static char* get_node_slug(const Node *node, FrontmatterCache *cache) {
     // Try slug from frontmatter first
-    char *slug = parse_slug_from_file(filepath);
+    char *slug;
+    if (node->values != NULL) {
+        const char *value = node->values[0];
+        slug = copy_slug(value, value != NULL ? strlen(value) : 0);
+    } else {
+        slug = parse_slug_from_file(node->path, cache);
+    }
     if (slug != NULL) {
         return slug;
     }
 
     // Fallback to folder name
-    return extract_folder_name(filepath);
+    return extract_folder_name(node->path);
 }
 
 /**
@@ -138,10 +149,9 @@ static char* get_node_slug(const char *filepath) {
  * Returns the parent node or NULL if no parent
  */
 static Node* find_parent_node(Node *node, EdgeList *edges) {
+    int parent_label = intern_find(&edges->labels, "parent");  // -1 matches no edge
     for (int i = 0; i < edges->count; i++) {
-        if (edges->items[i].src == node &&
-            edges->items[i].label != NULL &&
-            strcmp(edges->items[i].label, "parent") == 0) {
+        if (edges->items[i].src == node && edges->items[i].label == parent_label) {
             return edges->items[i].dst;
         }
     }
@@ -153,7 +163,8 @@ static Node* find_parent_node(Node *node, EdgeList *edges) {
  * Returns array of ancestor slugs (parent first, root last)
  * Sets *count to number of ancestors
  */
-static char** build_ancestor_chain(Node *node, EdgeList *edges, int *count) {
+static char** build_ancestor_chain(Node *node, EdgeList *edges, FrontmatterCache *cache,
+                                   int *count) {
     *count = 0;
     char **ancestors = NULL;
 
@@ -162,7 +173,7 @@ static char** build_ancestor_chain(Node *node, EdgeList *edges, int *count) {
 
     while (parent != NULL) {
         // Get slug for parent node
-        char *parent_slug = get_node_slug(parent->path);
+        char *parent_slug = get_node_slug(parent, cache);
         if (parent_slug == NULL) {
             parent = find_parent_node(parent, edges);
             continue;
@@ -212,32 +223,57 @@ static void print_hierarchy_yaml(const char *slug, char **ancestors, int ancesto
  * Entry point for hierarchy command
  */
 int hierarchy(int argc, char **argv) {
+    char delimiter = '\n';
+    FrontmatterCache *cache = NULL;
+    int use_cache = 0;
+    int status = 0;
+    const char *slug_key = "slug";
+    NodeFields slug_field = {&slug_key, 1};
+
     // Parse arguments
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             help();
             return 0;
+        } else if (strcmp(argv[i], "-0") == 0 || strcmp(argv[i], "--null") == 0) {
+            delimiter = '\0';
+        } else if (strcmp(argv[i], "--cache") == 0) {
+            use_cache = 1;
         }
     }
 
-    // Initialize node parser
-    if (init_node_parser() != 0) {
-        return 1;
+    if (use_cache) {
+        cache = frontmatter_cache_open();
+        if (cache == NULL) {
+            return 1;
+        }
     }
 
-    // Build nodes from stdin
-    NodeList *nodes = build_nodes_from_stdin();
-    if (nodes == NULL) {
-        cleanup_node_parser();
-        return 1;
+    // Build nodes from paths on stdin, or load a jig nodes/edges binary stream
+    NodeList *nodes = NULL;
+    EdgeList *edges = NULL;
+    if (graph_is_binary(stdin)) {
+        if (graph_read(stdin, &nodes, &edges) != 0) {
+            frontmatter_cache_close(cache);
+            return 1;
+        }
+    } else {
+        // The slug is parsed in the same read as id and title
+        nodes = build_nodes_from_stdin(delimiter, cache, &slug_field, 1);
+        if (nodes == NULL) {
+            frontmatter_cache_close(cache);
+            return 1;
+        }
     }
 
-    // Build edges from nodes
-    EdgeList *edges = build_edges_from_nodes(nodes);
+    // Build edges from nodes, unless the stream carried them
     if (edges == NULL) {
-        free_nodes(nodes);
-        cleanup_node_parser();
-        return 1;
+        edges = build_edges_from_nodes(nodes, cache);
+        if (edges == NULL) {
+            free_nodes(nodes);
+            frontmatter_cache_close(cache);
+            return 1;
+        }
     }
 
     // For each node, build and print hierarchy entry
@@ -245,12 +281,12 @@ int hierarchy(int argc, char **argv) {
         Node *node = &nodes->items[i];
 
         // Get slug for this node
-        char *slug = get_node_slug(node->path);
+        char *slug = get_node_slug(node, cache);
         if (slug == NULL) continue;
 
         // Build ancestor chain
         int ancestor_count = 0;
-        char **ancestors = build_ancestor_chain(node, edges, &ancestor_count);
+        char **ancestors = build_ancestor_chain(node, edges, cache, &ancestor_count);
 
         // Print YAML entry
         print_hierarchy_yaml(slug, ancestors, ancestor_count);
@@ -266,7 +302,10 @@ int hierarchy(int argc, char **argv) {
     // Cleanup
     free_edges(edges);
     free_nodes(nodes);
-    cleanup_node_parser();
+    if (cache != NULL) {
+        status = frontmatter_cache_save(cache);
+        frontmatter_cache_close(cache);
+    }
 
-    return 0;
+    return status;
 }
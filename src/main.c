@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "build/build.h"
 #include "config/config.h"
 #include "filter/filter.h"
 #include "find/find.h"
@@ -21,6 +22,7 @@ static void help(void) {
     printf("Knowledge graph management tool for organizing multi-lingual content.\n");
     printf("\n");
     printf("Commands:\n");
+    printf("  build               Build node and edge lists in one pass\n");
     printf("  config              Display parsed configuration\n");
     printf("  find                Find files in the graph\n");
     printf("  init                Initialize configuration file\n");
@@ -60,6 +62,10 @@ int main(int argc, char **argv) {
         return 0;
     }
 
+    if (strcmp(argv[1], "build") == 0) {
+        return build(argc - 1, argv + 1);
+    }
+
     if (strcmp(argv[1], "config") == 0) {
         return config(argc - 1, argv + 1);
     }
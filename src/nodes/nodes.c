@@ -2,14 +2,46 @@
 #include <string.h>
 #include <stdlib.h>
 #include <limits.h>
-#include <regex.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 #include "nodes.h"
+#include "frontmatter/frontmatter.h"
+#include "frontmatter/cache.h"
+#include "frontmatter/reader.h"
+#include "graph/graph.h"
+#include "csv/csv.h"
 
-// Global compiled regexes (static - internal only)
-static regex_t rgx_id;
-static regex_t rgx_title;
-static int regexes_compiled = 0;
+#define MAX_THREADS 256
+#define MAX_FIELDS 64
+#define PARSE_BATCH 64
+
+/**
+ * Nodes shared by the --threads workers
+ * Workers claim PARSE_BATCH consecutive nodes at a time from next; each
+ * node is written by exactly one worker
+ *
+ * Fields:
+ *   list  - Nodes with path set, id and title still to parse
+ *   cache - Parsed-note cache (--cache), or NULL
+ *   next  - Index of the first unclaimed node
+ */
+typedef struct {
+    NodeList *list;
+    FrontmatterCache *cache;
+    atomic_int next;
+} NodePool;
+
+/**
+ * Worker thread state; titles go to the worker's own arena, which the list
+ * adopts once the worker is joined
+ */
+typedef struct {
+    NodePool *pool;
+    Arena arena;
+    pthread_t thread;
+} NodeWorker;
 
 /**
  * Display help message
@@ -24,189 +56,522 @@ static void help(void) {
     printf("\n");
     printf("Options:\n");
     printf("  -h, --help          Display this help and exit\n");
+    printf("  -0, --null          Read NUL-separated paths (from jig find -0)\n");
+    printf("  -t, --threads N     Parse files with N worker threads (default: 1)\n");
+    printf("  -F, --fields KEYS   Also output these frontmatter keys (comma-separated)\n");
+    printf("      --stream        Print each row as soon as its file is parsed\n");
+    printf("      --format FMT    Output format: csv (default) or bin\n");
+    printf("      --cache         Reuse frontmatter parsed by earlier runs (%s)\n",
+           FRONTMATTER_CACHE_FILE);
     printf("\n");
     printf("Output Format:\n");
-    printf("  CSV with columns: id,title,path\n");
+    printf("  CSV with columns: id,title,path, then one column per -F key\n");
+    printf("  bin: binary node stream read by jig edges, jig tree and jig hierarchy\n");
     printf("\n");
     printf("Examples:\n");
     printf("  jig find . -p \"\\.md$\" | jig filter | jig nodes\n");
     printf("  jig-find . | jig-filter | jig-nodes\n");
+    printf("  jig find . | jig filter | jig nodes -t 8   Same output, parsed by 8 threads\n");
+    printf("  jig find . | jig filter | jig nodes --stream | head\n");
+    printf("  jig find . | jig filter | jig nodes -F slug,lang,draft,date\n");
 }
 
 /**
- * Initialize regex patterns for node parsing
- * Must be called before parse_node()
- * Returns 0 on success, non-zero on error
+ * Set node id (truncated to 36 bytes) and title from frontmatter values
+ * id and title may be NULL when the field is absent
  */
-int init_node_parser(void) {
-    if (regexes_compiled) return 0;
-
-    char *rgx_id_pattern = "id: (.*)";
-    char *rgx_title_pattern = "title: (.*)";
-    int rgx_result;
-
-    rgx_result = regcomp(&rgx_id, rgx_id_pattern, REG_EXTENDED | REG_ICASE | REG_NEWLINE);
-    if (rgx_result != 0) {
-        fprintf(stderr, "Could not compile regex: rgx_id_pattern\n");
-        return 1;
+static void set_node_fields(Node *node, Arena *arena, const char *id, size_t id_len,
+                            const char *title, size_t title_len) {
+    if (id != NULL) {
+        if (id_len > 36) {
+            id_len = 36;
+        }
+        memcpy(node->id, id, id_len);
+        node->id[id_len] = '\0';
     }
 
-    rgx_result = regcomp(&rgx_title, rgx_title_pattern, REG_EXTENDED | REG_ICASE | REG_NEWLINE);
-    if (rgx_result != 0) {
-        fprintf(stderr, "Could not compile regex: rgx_title_pattern\n");
-        return 1;
+    if (title != NULL) {
+        node->title = arena_strndup(arena, title, title_len);
     }
-
-    regexes_compiled = 1;
-    return 0;
 }
 
 /**
- * Free regex patterns
- * Should be called when done parsing nodes
+ * Copy the values of the extra keys into an array in arena
+ * Returns the array, or NULL on allocation failure
  */
-void cleanup_node_parser(void) {
-    if (!regexes_compiled) return;
+static char** copy_values(Arena *arena, const FrontmatterValue *found, int count) {
+    char **values = arena_alloc(arena, (size_t)count * sizeof(char*));
+    if (values == NULL) {
+        return NULL;
+    }
 
-    regfree(&rgx_id);
-    regfree(&rgx_title);
+    for (int i = 0; i < count; i++) {
+        values[i] = found[i].value != NULL ?
+                    arena_strndup(arena, found[i].value, found[i].len) : NULL;
+    }
+    return values;
+}
 
-    regexes_compiled = 0;
+/**
+ * Take the values of the extra keys from a cached note
+ * Returns 0 if every key is one the cache holds (id, title, slug), 1 if
+ * the file has to be read
+ */
+static int cached_values(const CachedNote *note, const NodeFields *fields,
+                         FrontmatterValue *values) {
+    for (int i = 0; fields != NULL && i < fields->count; i++) {
+        const char *key = fields->keys[i];
+        const char *value;
+
+        if (strcmp(key, "id") == 0) {
+            value = note->id;
+        } else if (strcmp(key, "title") == 0) {
+            value = note->title;
+        } else if (strcmp(key, "slug") == 0) {
+            value = note->slug;
+        } else {
+            return 1;
+        }
+        values[i].value = value;
+        values[i].len = value != NULL ? strlen(value) : 0;
+    }
+    return 0;
 }
 
 /**
- * Parse node fields (id, title) from file
- * Must call init_node_parser() first
+ * Parse node fields (id, title, extra keys) from the file's frontmatter
+ * With cache, unchanged files are not read again, unless an extra key is
+ * not one the cache holds
  */
-void parse_node(Node *node, const char *filepath) {
+void parse_node(Node *node, const char *filepath, FrontmatterCache *cache,
+                const NodeFields *fields, Arena *arena) {
+    NoteKey key;
+    CachedNote note;
+    int extra = fields != NULL ? fields->count : 0;
+    FrontmatterValue values[extra > 0 ? extra : 1];
+
     // Initialize fields to NULL/empty
     node->id[0] = '\0';
     node->title = NULL;
-
-    FILE *fptr = fopen(filepath, "r");
-    if (fptr == NULL) {
-        return;  // Skip file if can't open
+    node->values = NULL;
+
+    if (cache != NULL &&
+        frontmatter_cache_lookup(cache, filepath, &key, &note) == 0 &&
+        (note.flags & CACHED_FIELDS) && cached_values(&note, fields, values) == 0) {
+        set_node_fields(node, arena, note.id, note.id ? strlen(note.id) : 0,
+                        note.title, note.title ? strlen(note.title) : 0);
+        if (extra > 0) {
+            node->values = copy_values(arena, values, extra);
+        }
+        return;
     }
 
-    // Read file size
-    fseek(fptr, 0L, SEEK_END);
-    long filesize = ftell(fptr);
-    fseek(fptr, 0L, SEEK_SET);
-
-    // Read file content
-    char *filecontent = malloc(filesize + 1);
-    if (filecontent == NULL) {
-        fclose(fptr);
-        return;
+    FileView view;
+    if (file_view_open(&view, filepath) != 0) {
+        return;  // Skip file if can't open
     }
 
-    for (long j = 0; j < filesize; j++) {
-        filecontent[j] = fgetc(fptr);
+    // First id, title and value of each extra key win
+    FrontmatterFields found;
+    int has_frontmatter = frontmatter_fields_keys(view.data, view.len, &found,
+                                                  extra > 0 ? fields->keys : NULL,
+                                                  extra, values) == 0;
+    set_node_fields(node, arena, found.id, found.id_len, found.title, found.title_len);
+    if (extra > 0) {
+        node->values = copy_values(arena, values, extra);
     }
-    filecontent[filesize] = '\0';
-    fclose(fptr);
 
-    // Parse ID
-    regmatch_t rgx_id_matches[2];
-    int rgx_result = regexec(&rgx_id, filecontent, 2, rgx_id_matches, 0);
-    if (rgx_result == 0) {
-        int match_start = rgx_id_matches[1].rm_so;
-        int match_end = rgx_id_matches[1].rm_eo;
-        int match_length = match_end - match_start;
-        if (match_length > 36) {
-            match_length = 36;
-        }
-        strncpy(node->id, filecontent + match_start, match_length);
-        node->id[match_length] = '\0';
-    }
-
-    // Parse title
-    regmatch_t rgx_title_matches[2];
-    rgx_result = regexec(&rgx_title, filecontent, 2, rgx_title_matches, 0);
-    if (rgx_result == 0) {
-        int match_start = rgx_title_matches[1].rm_so;
-        int match_end = rgx_title_matches[1].rm_eo;
-        int match_length = match_end - match_start;
-
-        node->title = malloc(match_length + 1);
-        if (node->title != NULL) {
-            strncpy(node->title, filecontent + match_start, match_length);
-            node->title[match_length] = '\0';
-        }
+    if (cache != NULL) {
+        frontmatter_cache_store_fields(cache, &key, has_frontmatter, &found);
     }
 
-    free(filecontent);
+    file_view_close(&view);
 }
 
 /**
  * Add single node to list from filepath
- * Caller must have called init_node_parser() first
  */
-int add_node(NodeList *list, const char *filepath) {
-    // Grow array by one item
-    Node *tmp = realloc(list->items, (list->count + 1) * sizeof(Node));
-    if (tmp == NULL) {
+int add_node(NodeList *list, const char *filepath, FrontmatterCache *cache) {
+    // Make room for one more item
+    if (vector_reserve((void**)&list->items, &list->cap, list->count + 1, sizeof(Node)) != 0) {
         fprintf(stderr, "Failed to allocate memory for nodes\n");
         return 1;
     }
-    list->items = tmp;
 
     // Create new node
     Node *node = &list->items[list->count];
 
-    // Allocate and copy path
-    node->path = malloc(strlen(filepath) + 1);
+    // Copy path
+    node->path = arena_strdup(&list->arena, filepath);
     if (node->path == NULL) {
         fprintf(stderr, "Failed to allocate memory for path\n");
         return 1;
     }
-    strcpy(node->path, filepath);
 
     // Parse node fields from file
-    parse_node(node, filepath);
+    parse_node(node, filepath, cache, list->fields, &list->arena);
 
     list->count++;
     return 0;
 }
 
+/**
+ * Append a node with only its path set; id and title are parsed later
+ * Returns 0 on success, 1 on allocation failure
+ */
+static int add_unparsed_node(NodeList *list, const char *filepath) {
+    if (vector_reserve((void**)&list->items, &list->cap, list->count + 1, sizeof(Node)) != 0) {
+        fprintf(stderr, "Failed to allocate memory for nodes\n");
+        return 1;
+    }
+
+    Node *node = &list->items[list->count];
+    node->id[0] = '\0';
+    node->title = NULL;
+    node->values = NULL;
+    node->path = arena_strdup(&list->arena, filepath);
+    if (node->path == NULL) {
+        fprintf(stderr, "Failed to allocate memory for path\n");
+        return 1;
+    }
+
+    list->count++;
+    return 0;
+}
+
+/**
+ * Parse batches of nodes until every node is claimed
+ */
+static void* node_worker(void *arg) {
+    NodeWorker *worker = arg;
+    NodePool *pool = worker->pool;
+    int count = pool->list->count;
+
+    for (;;) {
+        int start = atomic_fetch_add(&pool->next, PARSE_BATCH);
+        if (start >= count) {
+            break;
+        }
+        int end = count - start < PARSE_BATCH ? count : start + PARSE_BATCH;
+        for (int i = start; i < end; i++) {
+            Node *node = &pool->list->items[i];
+            parse_node(node, node->path, pool->cache, pool->list->fields, &worker->arena);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Parse id and title of every node in list with a pool of worker threads
+ * Each worker has its own arena and file buffer; the cache is thread-safe
+ * Returns 0 on success, 1 on error
+ */
+static int parse_nodes_parallel(NodeList *list, FrontmatterCache *cache, int threads) {
+    NodePool pool = {list, cache, 0};
+    NodeWorker *workers = calloc(threads, sizeof(NodeWorker));
+    int started = 0;
+
+    if (workers == NULL) {
+        fprintf(stderr, "Failed to allocate memory for node workers\n");
+        return 1;
+    }
+
+    for (; started < threads; started++) {
+        NodeWorker *worker = &workers[started];
+        worker->pool = &pool;
+        if (pthread_create(&worker->thread, NULL, node_worker, worker) != 0) {
+            fprintf(stderr, "Failed to start worker thread\n");
+            break;
+        }
+    }
+
+    if (started == 0) {
+        // No worker: fall back to parsing in this thread
+        for (int i = 0; i < list->count; i++) {
+            parse_node(&list->items[i], list->items[i].path, cache, list->fields,
+                       &list->arena);
+        }
+    }
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i].thread, NULL);
+        arena_adopt(&list->arena, &workers[i].arena);
+    }
+    free(workers);
+
+    return 0;
+}
+
 /**
  * Read filepaths from stdin and build node list
- * Automatically calls init_node_parser() and cleanup_node_parser()
+ * Paths are separated by delimiter ('\n', or '\0' for -0/--null input)
  * Returns NodeList* or NULL on error
  */
-NodeList* build_nodes_from_stdin(void) {
-    char filepath[PATH_MAX];
+NodeList* build_nodes_from_stdin(char delimiter, FrontmatterCache *cache,
+                                 const NodeFields *fields, int threads) {
+    char *filepath = NULL;
+    size_t filepath_cap = 0;
+    ssize_t len;
 
-    NodeList *list = malloc(sizeof(NodeList));
+    NodeList *list = calloc(1, sizeof(NodeList));
     if (list == NULL) {
         fprintf(stderr, "Failed to allocate NodeList\n");
         return NULL;
     }
-    list->items = NULL;
-    list->count = 0;
+    list->fields = fields;
 
-    while (fgets(filepath, sizeof(filepath), stdin) != NULL) {
-        // Remove trailing newline
-        filepath[strcspn(filepath, "\n")] = '\0';
+    while ((len = getdelim(&filepath, &filepath_cap, delimiter, stdin)) != -1) {
+        // Remove trailing delimiter
+        if (len > 0 && filepath[len - 1] == delimiter) {
+            filepath[len - 1] = '\0';
+        }
 
-        // Add to node list
-        add_node(list, filepath);
+        // Add to node list; with threads, parse once every path is read
+        if (threads > 1) {
+            add_unparsed_node(list, filepath);
+        } else {
+            add_node(list, filepath, cache);
+        }
     }
+    free(filepath);
 
+    if (threads > 1 && parse_nodes_parallel(list, cache, threads) != 0) {
+        free_nodes(list);
+        return NULL;
+    }
     return list;
 }
 
 /**
- * Print nodes as CSV to stdout
- * Format: id,title,path
+ * Print the CSV header: id,title,path and the extra keys
  */
-void print_nodes_csv(NodeList *list) {
-    printf("id,title,path\n");
+static void print_node_header(FILE *out, const NodeFields *fields) {
+    fputs("id,title,path", out);
+    for (int i = 0; fields != NULL && i < fields->count; i++) {
+        putc(',', out);
+        csv_write_field(out, fields->keys[i]);
+    }
+    putc('\n', out);
+}
+
+/**
+ * Print one node as a CSV row: id,title,path and the extra values
+ */
+static void print_node_row(FILE *out, const Node *node, const NodeFields *fields) {
+    csv_write_field(out, node->id);
+    putc(',', out);
+    csv_write_field(out, node->title);
+    putc(',', out);
+    csv_write_field(out, node->path);
+    for (int i = 0; fields != NULL && i < fields->count; i++) {
+        putc(',', out);
+        csv_write_field(out, node->values != NULL ? node->values[i] : NULL);
+    }
+    putc('\n', out);
+}
+
+/**
+ * Parse each filepath from stdin and print its CSV row right away
+ */
+void stream_nodes_from_stdin(char delimiter, FrontmatterCache *cache,
+                             const NodeFields *fields) {
+    char *filepath = NULL;
+    size_t filepath_cap = 0;
+    ssize_t len;
+    Arena scratch = {0};  // Title and extra values of the current row
+    Node node;
+
+    print_node_header(stdout, fields);
+    while ((len = getdelim(&filepath, &filepath_cap, delimiter, stdin)) != -1) {
+        // Remove trailing delimiter
+        if (len > 0 && filepath[len - 1] == delimiter) {
+            filepath[len - 1] = '\0';
+        }
+
+        node.path = filepath;
+        parse_node(&node, filepath, cache, fields, &scratch);
+        print_node_row(stdout, &node, fields);
+        arena_reset(&scratch);
+    }
+
+    free(filepath);
+    arena_release(&scratch);
+}
+
+/**
+ * Print nodes as CSV to out
+ * Format: id,title,path, then one column per list->fields key
+ */
+void print_nodes_csv(FILE *out, NodeList *list) {
+    print_node_header(out, list->fields);
+    for (int i = 0; i < list->count; i++) {
+        print_node_row(out, &list->items[i], list->fields);
+    }
+}
+
+/**
+ * 64-bit FNV-1a hash of len bytes
+ */
+static uint64_t hash_key(const char *s, size_t len) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)s[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * Find the slot holding the key of len bytes, or the free slot where it
+ * would go; index->size must be non-zero
+ */
+static size_t index_slot(const NodeIndex *index, const char *key, size_t len) {
+    size_t mask = index->size - 1;
+    size_t slot = (size_t)hash_key(key, len) & mask;
+
+    while (index->keys[slot] != NULL &&
+           !(strncmp(index->keys[slot], key, len) == 0 && index->keys[slot][len] == '\0')) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * Allocate room for key_count keys, keeping the index at most half full
+ * Returns 0 on success, 1 on allocation failure
+ */
+static int index_init(NodeIndex *index, size_t key_count) {
+    size_t size = 16;
+    while (size / 2 < key_count) {
+        if (size > SIZE_MAX / 2 / sizeof(Node*)) {
+            return 1;
+        }
+        size *= 2;
+    }
+
+    index->keys = calloc(size, sizeof(char*));
+    index->nodes = malloc(size * sizeof(Node*));
+    index->size = size;
+    return index->keys == NULL || index->nodes == NULL;
+}
+
+/**
+ * Add a key unless it is already present (the first node wins)
+ */
+static void index_add(NodeIndex *index, const char *key, Node *node) {
+    size_t slot = index_slot(index, key, strlen(key));
+    if (index->keys[slot] == NULL) {
+        index->keys[slot] = key;
+        index->nodes[slot] = node;
+    }
+}
+
+/**
+ * Look up a key of len bytes
+ * Returns the node or NULL if the key is absent
+ */
+static Node* index_find(const NodeIndex *index, const char *key, size_t len) {
+    if (index->size == 0) {
+        return NULL;
+    }
+    size_t slot = index_slot(index, key, len);
+    return index->keys[slot] != NULL ? index->nodes[slot] : NULL;
+}
+
+/**
+ * Skip the leading "/" and "./" of a path, which links and node paths
+ * use interchangeably
+ */
+static const char* skip_path_prefix(const char *path, const char *end) {
+    for (;;) {
+        if (path < end && *path == '/') {
+            path++;
+        } else if (end - path >= 2 && path[0] == '.' && path[1] == '/') {
+            path += 2;
+        } else {
+            return path;
+        }
+    }
+}
+
+/**
+ * Build the id and path indexes of a complete list (rebuilt if present)
+ * A path is indexed under every suffix that starts a segment, so
+ * "notes/a/b.md" is found as "notes/a/b.md", "a/b.md" and "b.md"
+ * Returns 0 on success, 1 on allocation failure
+ */
+int index_nodes(NodeList *list) {
+    size_t path_keys = 0;
+
+    free_node_indexes(list);
+    for (int i = 0; i < list->count; i++) {
+        const char *path = list->items[i].path;
+        if (path == NULL) continue;
+        path_keys++;
+        for (const char *p = path; *p != '\0'; p++) {
+            path_keys += *p == '/';
+        }
+    }
+
+    if (index_init(&list->ids, (size_t)list->count) != 0 ||
+        index_init(&list->paths, path_keys) != 0) {
+        free_node_indexes(list);
+        return 1;
+    }
+
     for (int i = 0; i < list->count; i++) {
-        printf("%s,%s,%s\n",
-               list->items[i].id[0] ? list->items[i].id : "",
-               list->items[i].title ? list->items[i].title : "",
-               list->items[i].path ? list->items[i].path : "");
+        Node *node = &list->items[i];
+        if (node->id[0] != '\0') {
+            index_add(&list->ids, node->id, node);
+        }
+        if (node->path == NULL) continue;
+
+        const char *path = skip_path_prefix(node->path, node->path + strlen(node->path));
+        if (*path != '\0') {
+            index_add(&list->paths, path, node);
+        }
+        for (const char *p = path; *p != '\0'; p++) {
+            if (*p == '/' && p[1] != '\0') {
+                index_add(&list->paths, p + 1, node);
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Find a node by id
+ * Returns the node or NULL if there is none
+ */
+Node* find_node_by_id(const NodeList *list, const char *id) {
+    return index_find(&list->ids, id, strlen(id));
+}
+
+/**
+ * Find the node a link path of len bytes points to
+ * Returns the node or NULL if there is none
+ */
+Node* find_node_by_path(const NodeList *list, const char *path, size_t len) {
+    const char *start = skip_path_prefix(path, path + len);
+    len -= (size_t)(start - path);
+    if (len == 0) {
+        return NULL;
+    }
+    return index_find(&list->paths, start, len);
+}
+
+/**
+ * Free the id and path indexes
+ */
+void free_node_indexes(NodeList *list) {
+    NodeIndex *indexes[] = {&list->ids, &list->paths};
+
+    for (size_t i = 0; i < sizeof(indexes) / sizeof(indexes[0]); i++) {
+        free(indexes[i]->keys);
+        free(indexes[i]->nodes);
+        indexes[i]->keys = NULL;
+        indexes[i]->nodes = NULL;
+        indexes[i]->size = 0;
     }
 }
 
@@ -216,44 +581,153 @@ void print_nodes_csv(NodeList *list) {
 void free_nodes(NodeList *list) {
     if (list == NULL) return;
 
-    for (int i = 0; i < list->count; i++) {
-        free(list->items[i].path);
-        free(list->items[i].title);
-    }
+    free_node_indexes(list);
     free(list->items);
+    arena_release(&list->arena);
     free(list);
 }
 
+/**
+ * Append the comma-separated keys of a -F/--fields argument to fields
+ * The argument is split in place; keys point into it
+ * Returns 0 on success, 1 on error (message printed)
+ */
+static int parse_field_keys(char *arg, NodeFields *fields, const char **keys) {
+    for (char *key = arg; key != NULL; ) {
+        char *comma = strchr(key, ',');
+        if (comma != NULL) {
+            *comma = '\0';
+        }
+        if (*key == '\0') {
+            fprintf(stderr, "Error: -F/--fields requires comma-separated keys\n");
+            return 1;
+        }
+        if (fields->count == MAX_FIELDS) {
+            fprintf(stderr, "Error: -F/--fields accepts at most %d keys\n", MAX_FIELDS);
+            return 1;
+        }
+        keys[fields->count++] = key;
+        key = comma != NULL ? comma + 1 : NULL;
+    }
+    return 0;
+}
+
 /**
  * Entry point for nodes command
  */
 int nodes(int argc, char **argv) {
+    char delimiter = '\n';
+    FrontmatterCache *cache = NULL;
+    int use_cache = 0;
+    int threads = 1;
+    int stream = 0;
+    int binary = 0;
+    int status = 0;
+    const char *field_keys[MAX_FIELDS];
+    NodeFields fields = {field_keys, 0};
+
     // Parse arguments
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             help();
             return 0;
+        } else if (strcmp(argv[i], "-0") == 0 || strcmp(argv[i], "--null") == 0) {
+            delimiter = '\0';
+        } else if (strcmp(argv[i], "--cache") == 0) {
+            use_cache = 1;
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            stream = 1;
+        } else if (strcmp(argv[i], "--format") == 0) {
+            // Next argument should be the output format
+            if (i + 1 < argc && strcmp(argv[i + 1], "csv") == 0) {
+                binary = 0;
+            } else if (i + 1 < argc && strcmp(argv[i + 1], "bin") == 0) {
+                binary = 1;
+            } else {
+                fprintf(stderr, "Error: --format requires csv or bin\n");
+                return 1;
+            }
+            i++; // Skip next argument
+        } else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threads") == 0) {
+            // Next argument should be the thread count
+            if (i + 1 < argc) {
+                char *end;
+                long count = strtol(argv[i + 1], &end, 10);
+                if (*end != '\0' || count < 1 || count > MAX_THREADS) {
+                    fprintf(stderr, "Error: -t/--threads must be between 1 and %d\n", MAX_THREADS);
+                    return 1;
+                }
+                threads = (int)count;
+                i++; // Skip next argument
+            } else {
+                fprintf(stderr, "Error: -t/--threads requires a number argument\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-F") == 0 || strcmp(argv[i], "--fields") == 0) {
+            // Next argument should be the list of keys
+            if (i + 1 < argc) {
+                if (parse_field_keys(argv[i + 1], &fields, field_keys) != 0) {
+                    return 1;
+                }
+                i++; // Skip next argument
+            } else {
+                fprintf(stderr, "Error: -F/--fields requires a list of keys\n");
+                return 1;
+            }
         }
     }
 
-    // Initialize parser
-    if (init_node_parser() != 0) {
+    // Rows are printed in input order as they are parsed, one at a time
+    if (stream && threads > 1) {
+        fprintf(stderr, "Error: --stream cannot be combined with -t/--threads\n");
         return 1;
     }
 
-    // Build nodes from stdin
-    NodeList *nodes_list = build_nodes_from_stdin();
-    if (nodes_list == NULL) {
-        cleanup_node_parser();
+    // The binary header holds the node count, known only at the end
+    if (stream && binary) {
+        fprintf(stderr, "Error: --stream cannot be combined with --format bin\n");
         return 1;
     }
 
-    // Print as CSV
-    print_nodes_csv(nodes_list);
+    // The binary stream has no columns beyond id, title and path
+    if (fields.count > 0 && binary) {
+        fprintf(stderr, "Error: -F/--fields cannot be combined with --format bin\n");
+        return 1;
+    }
+
+    if (use_cache) {
+        cache = frontmatter_cache_open();
+        if (cache == NULL) {
+            return 1;
+        }
+    }
+
+    if (stream) {
+        stream_nodes_from_stdin(delimiter, cache, fields.count > 0 ? &fields : NULL);
+    } else {
+        // Build nodes from stdin
+        NodeList *nodes_list = build_nodes_from_stdin(delimiter, cache,
+                                                      fields.count > 0 ? &fields : NULL,
+                                                      threads);
+        if (nodes_list == NULL) {
+            frontmatter_cache_close(cache);
+            return 1;
+        }
+
+        // Print as CSV or binary stream
+        if (binary) {
+            status = graph_write(stdout, nodes_list, NULL);
+        } else {
+            print_nodes_csv(stdout, nodes_list);
+        }
+        free_nodes(nodes_list);
+    }
 
     // Cleanup
-    free_nodes(nodes_list);
-    cleanup_node_parser();
+    if (cache != NULL) {
+        status |= frontmatter_cache_save(cache);
+        frontmatter_cache_close(cache);
+    }
 
-    return 0;
+    return status;
 }
@@ -1,70 +1,141 @@
 #ifndef NODES_H
 #define NODES_H
 
+#include <stdio.h>
+#include "alloc/alloc.h"
+#include "frontmatter/cache.h"
+
 /**
  * Represents a single node in the knowledge graph
  * Parsed from markdown file with YAML frontmatter
  *
  * Fields:
- *   id    - Unique identifier (max 36 chars, typically UUID)
- *   path  - Full file path to the source file
- *   title - Human-readable node title
+ *   id     - Unique identifier (max 36 chars, typically UUID)
+ *   path   - Full file path to the source file
+ *   title  - Human-readable node title
+ *   values - Value of each extra key (NodeFields), NULL where the key is
+ *            absent; the array itself is NULL if no extra keys were parsed
  */
 typedef struct {
     char id[37];
     char *path;
     char *title;
+    char **values;
 } Node;
 
+/**
+ * Extra frontmatter keys parsed along with id and title (-F/--fields)
+ *
+ * Fields:
+ *   keys  - Frontmatter keys, in output column order
+ *   count - Number of keys
+ */
+typedef struct {
+    const char **keys;
+    int count;
+} NodeFields;
+
+/**
+ * Open-addressing hash from a string key to a node
+ * Keys point into the nodes' own strings, so the index copies nothing.
+ * A zeroed NodeIndex is empty.
+ *
+ * Fields:
+ *   keys  - Key of each slot, or NULL if the slot is free
+ *   nodes - Node of each slot
+ *   size  - Number of slots (a power of two, or 0 when empty)
+ */
+typedef struct {
+    const char **keys;
+    Node **nodes;
+    size_t size;
+} NodeIndex;
+
 /**
  * Dynamic array of nodes
  *
  * Fields:
  *   items - Array of Node structures
  *   count - Number of nodes in the array
+ *   cap   - Allocated length of items
+ *   arena  - Holds the path, title and extra value strings of all nodes
+ *   fields - Extra keys parsed for every node, or NULL
+ *   ids    - Index by id, built by index_nodes()
+ *   paths  - Index by canonical path suffix, built by index_nodes()
  */
 typedef struct {
     Node *items;
     int count;
+    int cap;
+    Arena arena;
+    const NodeFields *fields;
+    NodeIndex ids;
+    NodeIndex paths;
 } NodeList;
 
 /**
- * Initialize regex patterns for node parsing
- * Must be called before parse_node()
- * Returns 0 on success, non-zero on error
+ * Parse node fields (id, title, and the fields keys if not NULL) from the
+ * file's frontmatter, in one read of the file
+ * Strings are allocated in arena; cache (--cache) may be NULL
  */
-int init_node_parser(void);
+void parse_node(Node *node, const char *filepath, FrontmatterCache *cache,
+                const NodeFields *fields, Arena *arena);
 
 /**
- * Free regex patterns
- * Should be called when done parsing nodes
+ * Add single node to list from filepath, parsing list->fields too
  */
-void cleanup_node_parser(void);
+int add_node(NodeList *list, const char *filepath, FrontmatterCache *cache);
 
 /**
- * Parse node fields (id, title) from file
- * Must call init_node_parser() first
+ * Read filepaths from stdin and build node list
+ * Paths are separated by delimiter ('\n', or '\0' for -0/--null input);
+ * with threads > 1 the files are parsed by that many worker threads,
+ * nodes stay in input order; fields (-F/--fields) may be NULL
+ * Returns NodeList* or NULL on error
  */
-void parse_node(Node *node, const char *filepath);
+NodeList* build_nodes_from_stdin(char delimiter, FrontmatterCache *cache,
+                                 const NodeFields *fields, int threads);
 
 /**
- * Add single node to list from filepath
- * Caller must have called init_node_parser() first
+ * Parse each filepath from stdin and print its CSV row right away
+ * Nothing is kept once a row is printed, so memory does not grow with input
  */
-int add_node(NodeList *list, const char *filepath);
+void stream_nodes_from_stdin(char delimiter, FrontmatterCache *cache,
+                             const NodeFields *fields);
 
 /**
- * Read filepaths from stdin and build node list
- * Automatically calls init_node_parser() and cleanup_node_parser()
- * Returns NodeList* or NULL on error
+ * Print nodes as CSV to out
+ * Format: id,title,path, then one column per list->fields key
+ */
+void print_nodes_csv(FILE *out, NodeList *list);
+
+/**
+ * Build the id and path indexes of a complete list (rebuilt if present)
+ * Nodes must not be added afterwards: the indexes point into items
+ * With duplicate keys the first node in list order wins
+ * Returns 0 on success, 1 on allocation failure
+ */
+int index_nodes(NodeList *list);
+
+/**
+ * Find a node by id (index_nodes() must have been called)
+ * Returns the node or NULL if there is none
+ */
+Node* find_node_by_id(const NodeList *list, const char *id);
+
+/**
+ * Find the node a link path points to (index_nodes() must have been called)
+ * Matches len bytes of path against whole path segments at the end of
+ * each node's path, ignoring leading "/" and "./": "/a/b.md" finds
+ * "notes/a/b.md" but not "notes/xa/b.md"
+ * Returns the node or NULL if there is none
  */
-NodeList* build_nodes_from_stdin(void);
+Node* find_node_by_path(const NodeList *list, const char *path, size_t len);
 
 /**
- * Print nodes as CSV to stdout
- * Format: id,title,path
+ * Free the id and path indexes
  */
-void print_nodes_csv(NodeList *list);
+void free_node_indexes(NodeList *list);
 
 /**
  * Free node list memory
@@ -8,6 +8,7 @@
 #include "../uuid/uuid.h"
 #include "../slugify/slugify.h"
 #include "../nodes/nodes.h"
+#include "../frontmatter/reader.h"
 
 #define MAX_TEMPLATE_SIZE 10485760  /* 10MB */
 
@@ -96,32 +97,28 @@ static char *get_default_template(void) {
 }
 
 static char *read_template_file(const char *filepath) {
-    FILE *fptr = fopen(filepath, "r");
-    if (fptr == NULL) {
+    FileView view;
+    if (file_view_open(&view, filepath) != 0) {
         fprintf(stderr, "Error: Cannot open template file '%s'\n", filepath);
         return NULL;
     }
 
-    fseek(fptr, 0L, SEEK_END);
-    long filesize = ftell(fptr);
-    fseek(fptr, 0L, SEEK_SET);
-
-    if (filesize > MAX_TEMPLATE_SIZE) {
+    if (view.len > MAX_TEMPLATE_SIZE) {
         fprintf(stderr, "Error: Template file too large (max 10MB)\n");
-        fclose(fptr);
+        file_view_close(&view);
         return NULL;
     }
 
-    char *content = malloc(filesize + 1);
+    /* Placeholders are replaced with string functions: keep a terminated copy */
+    char *content = malloc(view.len + 1);
     if (content == NULL) {
         fprintf(stderr, "Error: Memory allocation failed\n");
-        fclose(fptr);
+        file_view_close(&view);
         return NULL;
     }
-
-    size_t read = fread(content, 1, filesize, fptr);
-    content[read] = '\0';
-    fclose(fptr);
+    memcpy(content, view.data, view.len);
+    content[view.len] = '\0';
+    file_view_close(&view);
 
     return content;
 }
@@ -329,18 +326,13 @@ static int resolve_link(const char *label, const char *folder_path,
     }
 
     /* Parse target file to get title */
-    if (init_node_parser() != 0) {
-        fprintf(stderr, "Error: Failed to initialize node parser\n");
-        return 1;
-    }
-
     Node node = {0};
-    parse_node(&node, target_path);
-    cleanup_node_parser();
+    Arena arena = {0};
+    parse_node(&node, target_path, NULL, NULL, &arena);
 
     if (node.title == NULL) {
         fprintf(stderr, "Error: Cannot extract title from '%s'\n", target_path);
-        free(node.path);
+        arena_release(&arena);
         return 1;
     }
 
@@ -351,11 +343,11 @@ static int resolve_link(const char *label, const char *folder_path,
     if (out->path != NULL) {
         snprintf(out->path, path_len, "/%s", target_path);
     }
-    out->title = node.title;  /* Take ownership */
+    out->title = strdup(node.title);
 
-    free(node.path);
+    arena_release(&arena);
 
-    if (out->label == NULL || out->path == NULL) {
+    if (out->label == NULL || out->path == NULL || out->title == NULL) {
         free(out->label);
         free(out->path);
         free(out->title);
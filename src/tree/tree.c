@@ -5,6 +5,8 @@
 #include "tree.h"
 #include "nodes/nodes.h"
 #include "edges/edges.h"
+#include "graph/graph.h"
+#include "frontmatter/cache.h"
 
 /**
  * Display help message
@@ -15,13 +17,19 @@ static void help(void) {
     printf("\n");
     printf("Generate and display a tree structure of notes based on parent-child relationships.\n");
     printf("\n");
+    printf("Reads file paths from stdin, or a jig nodes/edges --format bin stream.\n");
+    printf("\n");
     printf("Options:\n");
     printf("  -h, --help          Display this help and exit\n");
     printf("  -f, --format FORMAT Output format (md for markdown links)\n");
+    printf("  -0, --null          Read NUL-separated paths (from jig find -0)\n");
+    printf("      --cache         Reuse notes parsed by earlier runs (%s)\n",
+           FRONTMATTER_CACHE_FILE);
     printf("\n");
     printf("Examples:\n");
     printf("  jig find . -p \"\\.md$\" | jig filter | jig tree        Generate tree from markdown files\n");
     printf("  jig find . -p \"\\.md$\" | jig filter | jig tree -f md   Output with markdown links\n");
+    printf("  jig find . | jig filter | jig nodes --format bin | jig edges --format bin | jig tree\n");
 }
 
 /**
@@ -30,12 +38,11 @@ static void help(void) {
  * Returns number of children found
  */
 static int get_children(EdgeList *edges, Node *parent, Node **children, int max_children) {
+    int parent_label = intern_find(&edges->labels, "parent");  // -1 matches no edge
     int count = 0;
     for (int i = 0; i < edges->count && count < max_children; i++) {
         // Only consider parent edges for tree visualization
-        if (edges->items[i].dst == parent &&
-            edges->items[i].label != NULL &&
-            strcmp(edges->items[i].label, "parent") == 0) {
+        if (edges->items[i].dst == parent && edges->items[i].label == parent_label) {
             children[count++] = edges->items[i].src;
         }
     }
@@ -95,6 +102,8 @@ static void print_tree_node(Node *node, EdgeList *edges, int depth, char *prefix
  * Print tree structure starting from root nodes
  */
 static void print_tree(NodeList *nodes, EdgeList *edges, const char *format) {
+    int parent_label = intern_find(&edges->labels, "parent");
+
     // Find root nodes (nodes with no outgoing parent edge)
     for (int i = 0; i < nodes->count; i++) {
         int is_root = 1;
@@ -102,8 +111,7 @@ static void print_tree(NodeList *nodes, EdgeList *edges, const char *format) {
         // Check if node has a parent edge pointing out
         for (int j = 0; j < edges->count; j++) {
             if (edges->items[j].src == &nodes->items[i] &&
-                edges->items[j].label != NULL &&
-                strcmp(edges->items[j].label, "parent") == 0) {
+                edges->items[j].label == parent_label) {
                 is_root = 0;
                 break;
             }
@@ -120,6 +128,10 @@ static void print_tree(NodeList *nodes, EdgeList *edges, const char *format) {
  */
 int tree(int argc, char **argv) {
     char *format = NULL;
+    char delimiter = '\n';
+    FrontmatterCache *cache = NULL;
+    int use_cache = 0;
+    int status = 0;
 
     // Parse arguments
     for (int i = 1; i < argc; i++) {
@@ -134,27 +146,44 @@ int tree(int argc, char **argv) {
                 fprintf(stderr, "Error: -f/--format requires a value\n");
                 return 1;
             }
+        } else if (strcmp(argv[i], "-0") == 0 || strcmp(argv[i], "--null") == 0) {
+            delimiter = '\0';
+        } else if (strcmp(argv[i], "--cache") == 0) {
+            use_cache = 1;
         }
     }
 
-    // Initialize node parser
-    if (init_node_parser() != 0) {
-        return 1;
+    if (use_cache) {
+        cache = frontmatter_cache_open();
+        if (cache == NULL) {
+            return 1;
+        }
     }
 
-    // Build nodes from stdin
-    NodeList *nodes = build_nodes_from_stdin();
-    if (nodes == NULL) {
-        cleanup_node_parser();
-        return 1;
+    // Build nodes from paths on stdin, or load a jig nodes/edges binary stream
+    NodeList *nodes = NULL;
+    EdgeList *edges = NULL;
+    if (graph_is_binary(stdin)) {
+        if (graph_read(stdin, &nodes, &edges) != 0) {
+            frontmatter_cache_close(cache);
+            return 1;
+        }
+    } else {
+        nodes = build_nodes_from_stdin(delimiter, cache, NULL, 1);
+        if (nodes == NULL) {
+            frontmatter_cache_close(cache);
+            return 1;
+        }
     }
 
-    // Build edges from nodes
-    EdgeList *edges = build_edges_from_nodes(nodes);
+    // Build edges from nodes, unless the stream carried them
     if (edges == NULL) {
-        free_nodes(nodes);
-        cleanup_node_parser();
-        return 1;
+        edges = build_edges_from_nodes(nodes, cache);
+        if (edges == NULL) {
+            free_nodes(nodes);
+            frontmatter_cache_close(cache);
+            return 1;
+        }
     }
 
     // Print tree structure
@@ -163,7 +192,10 @@ int tree(int argc, char **argv) {
     // Cleanup
     free_edges(edges);
     free_nodes(nodes);
-    cleanup_node_parser();
+    if (cache != NULL) {
+        status = frontmatter_cache_save(cache);
+        frontmatter_cache_close(cache);
+    }
 
-    return 0;
+    return status;
 }